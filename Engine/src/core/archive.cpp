@@ -0,0 +1,281 @@
+#include "core/archive.h"
+
+#include "core/assert.h"
+#include "core/log.h"
+#include "core/memory.h"
+#include "core/lz4.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+namespace ddls {
+
+Boolean Archive::mount(const std::filesystem::path &path)
+{
+    // Remounting unmaps the previous archive, its entries go with it
+    _entries = {};
+    // Entries are looked up in scattered places
+    if (!_file.open(path, FileAccess::Random)) return false;
+
+    ArchiveHeader header{};
+    Boolean valid = _file.size() >= sizeof(ArchiveHeader);
+    if (valid) std::memcpy(&header, _file.data(), sizeof(ArchiveHeader));
+    valid = valid && header.magic == Magic && header.version == Version && isPowerOfTwo(header.alignment)
+        && (_file.size() - sizeof(ArchiveHeader)) / sizeof(ArchiveEntry) >= header.entryCount;
+
+    if (valid) _entries = {(const ArchiveEntry *) (_file.data() + sizeof(ArchiveHeader)), header.entryCount};
+    for (u64 i = 0; valid && i < _entries.size(); i++)
+    {
+        const ArchiveEntry &entry = _entries[i];
+        valid = entry.offset <= _file.size() && entry.storedSize <= _file.size() - entry.offset
+            && (i == 0 || _entries[i - 1].name < entry.name);
+    }
+
+    // Nothing of a rejected archive stays mapped
+    if (!valid)
+    {
+        _entries = {};
+        _file.close();
+    }
+
+    return valid;
+}
+
+const ArchiveEntry *Archive::find(StringId name) const
+{
+    auto entry = std::lower_bound(_entries.begin(), _entries.end(), name.value(),
+        [](const ArchiveEntry &candidate, u64 value) { return candidate.name < value; });
+
+    return entry != _entries.end() && entry->name == name.value() ? &*entry : nullptr;
+}
+
+std::span<const char> Archive::view(const ArchiveEntry &entry) const
+{
+    return {_file.data() + entry.offset, (std::size_t) entry.storedSize};
+}
+
+static constexpr u32 StoredBlock = 0x80000000;
+
+/**
+ * @brief Blocks of an entry being decoded, claimed one at a time by every participating thread
+ * 
+ * Shared with the workers, which may only get to run once every block is already decoded.
+ * 
+ */
+struct BlockDecode
+{
+    const u8 *blocks;
+    std::vector<u32> storedSizes;
+    std::vector<u64> offsets;
+    u8 *destination;
+    u64 size;
+    u32 blockSize;
+    u32 blockCount;
+
+    std::atomic<u32> next{0};
+    std::atomic<u32> remaining{0};
+    std::atomic<bool> failed{false};
+
+    void run()
+    {
+        for (u32 block = next.fetch_add(1); block < blockCount; block = next.fetch_add(1))
+        {
+            u64 start = (u64) block * blockSize;
+            u64 blockBytes = std::min<u64>(blockSize, size - start);
+            u64 storedBytes = offsets[block + 1] - offsets[block];
+            const u8 *source = blocks + offsets[block];
+
+            Boolean decoded;
+            if (storedSizes[block] & StoredBlock)
+            {
+                decoded = storedBytes == blockBytes;
+                if (decoded) std::memcpy(destination + start, source, blockBytes);
+            }
+            else
+            {
+                decoded = Lz4::Decompress(source, storedBytes, destination + start, blockBytes);
+            }
+            if (!decoded) failed.store(true, std::memory_order_relaxed);
+
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) remaining.notify_all();
+        }
+    }
+};
+
+Boolean Archive::read(const ArchiveEntry &entry, char *destination, WorkerPool *workers) const
+{
+    const u8 *payload = (const u8 *) _file.data() + entry.offset;
+
+    switch (entry.compression)
+    {
+        case Compression::None:
+            if (entry.storedSize != entry.size) return false;
+            std::memcpy(destination, payload, entry.size);
+            return true;
+
+        case Compression::Lz4Blocks:
+        {
+            u32 header[2];
+            if (entry.storedSize < sizeof(header)) return false;
+            std::memcpy(header, payload, sizeof(header));
+
+            auto decode = std::make_shared<BlockDecode>();
+            decode->blockSize = header[0];
+            decode->blockCount = header[1];
+            u64 tableSize = sizeof(header) + (u64) decode->blockCount * sizeof(u32);
+            if (!decode->blockSize || tableSize > entry.storedSize) return false;
+            if (decode->blockCount != (entry.size + decode->blockSize - 1) / decode->blockSize) return false;
+
+            decode->blocks = payload + tableSize;
+            decode->destination = (u8 *) destination;
+            decode->size = entry.size;
+            // Payloads may be less aligned than the table
+            decode->storedSizes.resize(decode->blockCount);
+            std::memcpy(decode->storedSizes.data(), payload + sizeof(header), decode->blockCount * sizeof(u32));
+            decode->offsets.resize(decode->blockCount + 1);
+            for (u32 block = 0; block < decode->blockCount; block++)
+            {
+                decode->offsets[block + 1] = decode->offsets[block] + (decode->storedSizes[block] & ~StoredBlock);
+            }
+            if (decode->offsets.back() > entry.storedSize - tableSize) return false;
+
+            decode->remaining.store(decode->blockCount, std::memory_order_relaxed);
+            u32 helpers = workers && decode->blockCount > 1 ? std::min(workers->threadCount(), decode->blockCount - 1) : 0;
+            for (u32 i = 0; i < helpers; i++) workers->submit([decode] { decode->run(); });
+
+            // The calling thread decodes too, so this can't deadlock when called from a worker
+            decode->run();
+            for (u32 left = decode->remaining.load(std::memory_order_acquire); left;
+                left = decode->remaining.load(std::memory_order_acquire))
+            {
+                decode->remaining.wait(left, std::memory_order_acquire);
+            }
+
+            return !decode->failed.load(std::memory_order_relaxed);
+        }
+    }
+
+    return false;
+}
+
+ArchiveWriter::ArchiveWriter(u32 alignment, u32 blockSize) : _alignment(alignment), _blockSize(blockSize)
+{
+    Assert(isPowerOfTwo(alignment),
+        fmt::format("Archive alignment {} is not a power of two!", alignment));
+    Assert(blockSize > 0 && blockSize < StoredBlock,
+        fmt::format("Archive block size {} is out of range!", blockSize));
+}
+
+void ArchiveWriter::add(std::string_view name, std::vector<char> contents, Compression compression)
+{
+    u64 size = contents.size();
+    if (compression == Compression::Lz4Blocks)
+    {
+        std::vector<char> compressed = compressBlocks(contents);
+        if (compressed.size() < size) contents = std::move(compressed);
+        else compression = Compression::None;
+    }
+
+    _entries.push_back(Pending{StringId(name), std::string(name), std::move(contents), size, compression});
+}
+
+std::vector<char> ArchiveWriter::compressBlocks(const std::vector<char> &contents) const
+{
+    u32 blockCount = (u32) ((contents.size() + _blockSize - 1) / _blockSize);
+    u64 tableSize = 2 * sizeof(u32) + (u64) blockCount * sizeof(u32);
+
+    std::vector<char> compressed(tableSize);
+    u32 header[2] = {_blockSize, blockCount};
+    std::memcpy(compressed.data(), header, sizeof(header));
+
+    std::vector<u8> block(Lz4::CompressBound(_blockSize));
+    for (u32 i = 0; i < blockCount; i++)
+    {
+        const char *source = contents.data() + (u64) i * _blockSize;
+        u64 blockBytes = std::min<u64>(_blockSize, contents.size() - (u64) i * _blockSize);
+        u64 storedBytes = Lz4::Compress((const u8 *) source, blockBytes, block.data(), block.size());
+
+        // Blocks that don't shrink are stored as is, decoding them is a copy
+        u32 storedSize = (u32) storedBytes;
+        if (!storedBytes || storedBytes >= blockBytes)
+        {
+            compressed.insert(compressed.end(), source, source + blockBytes);
+            storedSize = (u32) blockBytes | StoredBlock;
+        }
+        else
+        {
+            compressed.insert(compressed.end(), (const char *) block.data(), (const char *) block.data() + storedBytes);
+        }
+        std::memcpy(compressed.data() + 2 * sizeof(u32) + i * sizeof(u32), &storedSize, sizeof(storedSize));
+    }
+
+    return compressed;
+}
+
+Boolean ArchiveWriter::addFile(std::string_view name, const std::filesystem::path &path, Compression compression)
+{
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) return false;
+
+    std::vector<char> contents((u64) file.tellg());
+    file.seekg(0);
+    file.read(contents.data(), (std::streamsize) contents.size());
+    if (!file) return false;
+
+    add(name, std::move(contents), compression);
+
+    return true;
+}
+
+Boolean ArchiveWriter::write(const std::filesystem::path &path) const
+{
+    std::vector<const Pending *> sorted;
+    sorted.reserve(_entries.size());
+    for (const Pending &entry : _entries) sorted.push_back(&entry);
+    std::sort(sorted.begin(), sorted.end(),
+        [](const Pending *a, const Pending *b) { return a->id < b->id; });
+
+    for (u64 i = 1; i < sorted.size(); i++)
+    {
+        if (sorted[i - 1]->id != sorted[i]->id) continue;
+        Log::Error(LogCategory::Resources, "Archive entries \"", sorted[i - 1]->name, "\" and \"", sorted[i]->name, "\" have the same hash!");
+        return false;
+    }
+
+    ArchiveHeader header{Archive::Magic, Archive::Version, (u32) sorted.size(), _alignment};
+    std::vector<ArchiveEntry> entries(sorted.size());
+    u64 offset = sizeof(ArchiveHeader) + sorted.size() * sizeof(ArchiveEntry);
+    for (u64 i = 0; i < sorted.size(); i++)
+    {
+        offset = alignForward(offset, _alignment);
+        u64 storedSize = sorted[i]->contents.size();
+        entries[i] = ArchiveEntry{sorted[i]->id.value(), offset, storedSize, sorted[i]->size, sorted[i]->compression, 0};
+        offset += storedSize;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    file.write((const char *) &header, sizeof(header));
+    file.write((const char *) entries.data(), (std::streamsize) (entries.size() * sizeof(ArchiveEntry)));
+    u64 position = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+    const char padding[64]{};
+    for (u64 i = 0; i < sorted.size(); i++)
+    {
+        while (position < entries[i].offset)
+        {
+            u64 count = std::min<u64>(entries[i].offset - position, sizeof(padding));
+            file.write(padding, (std::streamsize) count);
+            position += count;
+        }
+        file.write(sorted[i]->contents.data(), (std::streamsize) sorted[i]->contents.size());
+        position += sorted[i]->contents.size();
+    }
+
+    return (Boolean) file.good();
+}
+
+} // namespace ddls
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+#include "core/error.h"
+#include "core/mapped_file.h"
+#include "core/string_id.h"
+#include "core/worker_pool.h"
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ddls {
+
+/**
+ * @brief How an archived payload is stored
+ * 
+ */
+enum class Compression : u32
+{
+    None,
+    /**
+     * @brief Independently decompressible LZ4 blocks
+     * 
+     * The payload starts with the block size and count, followed by the stored size of each block,
+     * its high bit set if the block didn't compress and is stored as is, then the blocks.
+     */
+    Lz4Blocks
+};
+
+/**
+ * @brief The start of an archive, followed by its table of contents
+ * 
+ * Archives are little-endian, a byte-swapped magic is rejected when mounting.
+ * 
+ */
+struct ArchiveHeader
+{
+    u32 magic;
+    u32 version;
+    u32 entryCount;
+    u32 alignment;
+};
+
+/**
+ * @brief A table of contents entry, the table is sorted by name hash
+ * 
+ */
+struct ArchiveEntry
+{
+    /** @brief The StringId of the entry's name */
+    u64 name;
+    /** @brief Offset of the payload from the start of the archive, a multiple of the alignment */
+    u64 offset;
+    /** @brief Size of the payload as stored */
+    u64 storedSize;
+    /** @brief Size of the contents once decompressed */
+    u64 size;
+    Compression compression;
+    u32 reserved;
+};
+
+static_assert(sizeof(ArchiveHeader) == 16 && sizeof(ArchiveEntry) == 40, "The archive layout must not depend on padding");
+
+/**
+ * @brief A read-only archive of named files, mapped into memory
+ * 
+ * Lookups binary search the table of contents, and uncompressed payloads are viewed in place.
+ * 
+ */
+class DDLS_API Archive
+{
+public:
+    static constexpr u32 Magic = 0x414C4444; // "DDLA"
+    static constexpr u32 Version = 1;
+    static constexpr u32 DefaultAlignment = 16;
+    static constexpr u32 DefaultBlockSize = 256 * 1024;
+
+    /**
+     * @brief Maps the archive at the given path and checks its table of contents
+     * 
+     * @return false if the file cannot be mapped or isn't a valid archive
+     */
+    Boolean mount(const std::filesystem::path &path);
+
+    /**
+     * @brief Finds the entry of a name
+     * 
+     * @return const ArchiveEntry* nullptr if the archive doesn't contain it
+     */
+    const ArchiveEntry *find(StringId name) const;
+
+    /**
+     * @brief Views the payload of an entry as stored, without copying it
+     * 
+     */
+    std::span<const char> view(const ArchiveEntry &entry) const;
+
+    /**
+     * @brief Copies the contents of an entry, destination must hold entry.size bytes
+     * 
+     * @param workers If given, compressed blocks are also decoded by its workers
+     * @return false if the payload is corrupt
+     */
+    Boolean read(const ArchiveEntry &entry, char *destination, WorkerPool *workers = nullptr) const;
+
+    std::span<const ArchiveEntry> entries() const { return _entries; }
+
+private:
+    MappedFile _file;
+    std::span<const ArchiveEntry> _entries;
+};
+
+/**
+ * @brief Builds an archive out of named files
+ * 
+ */
+class DDLS_API ArchiveWriter
+{
+public:
+    explicit ArchiveWriter(u32 alignment = Archive::DefaultAlignment, u32 blockSize = Archive::DefaultBlockSize);
+
+    /**
+     * @brief Adds a named entry with the given contents
+     * 
+     * @param compression Falls back to None if compressing doesn't save space
+     */
+    void add(std::string_view name, std::vector<char> contents, Compression compression = Compression::None);
+
+    /**
+     * @brief Adds the file at the given path under a name
+     * 
+     * @return false if the file cannot be read
+     */
+    Boolean addFile(std::string_view name, const std::filesystem::path &path,
+        Compression compression = Compression::None);
+
+    /**
+     * @brief Writes the archive, failing on name hash collisions
+     * 
+     */
+    Boolean write(const std::filesystem::path &path) const;
+
+    u64 entryCount() const { return _entries.size(); }
+
+private:
+    struct Pending
+    {
+        StringId id;
+        std::string name;
+        std::vector<char> contents;
+        u64 size;
+        Compression compression;
+    };
+
+    std::vector<char> compressBlocks(const std::vector<char> &contents) const;
+
+    u32 _alignment;
+    u32 _blockSize;
+    std::vector<Pending> _entries;
+};
+
+} // namespace ddls
@@ -18,6 +18,7 @@ namespace ddls {
     else \
     { \
         reportAssertionFailure(#expr, __FILE__, __LINE__); \
+        ddls::Log::Flush(); \
         debugBreak(); \
     }
 
@@ -27,6 +28,7 @@ namespace ddls {
     { \
         Log::Out(Log::Styles::Bold, Log::Colours::Magenta, Log::Level::Assert, args); \
         reportAssertionFailure(#expr, __FILE__, __LINE__); \
+        ddls::Log::Flush(); \
         debugBreak(); \
     }
 
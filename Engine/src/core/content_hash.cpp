@@ -0,0 +1,95 @@
+#include "core/content_hash.h"
+
+#include <cstring>
+
+namespace ddls {
+
+static constexpr u64 Prime1 = 0x9E3779B185EBCA87ull;
+static constexpr u64 Prime2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr u64 Prime3 = 0x165667B19E3779F9ull;
+static constexpr u64 Prime4 = 0x85EBCA77C2B2AE63ull;
+static constexpr u64 Prime5 = 0x27D4EB2F165667C5ull;
+
+static u64 rotateLeft(u64 value, u32 bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static u64 read64(const u8 *bytes)
+{
+    u64 value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static u32 read32(const u8 *bytes)
+{
+    u32 value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static u64 round(u64 accumulator, u64 input)
+{
+    accumulator += input * Prime2;
+    return rotateLeft(accumulator, 31) * Prime1;
+}
+
+static u64 merge(u64 hash, u64 accumulator)
+{
+    hash ^= round(0, accumulator);
+    return hash * Prime1 + Prime4;
+}
+
+u64 ContentHash::Of(const void *data, u64 size, u64 seed)
+{
+    const u8 *bytes = (const u8 *) data;
+    const u8 *end = bytes + size;
+    u64 hash;
+
+    if (size >= 32)
+    {
+        // Four independent lanes over 32-byte stripes
+        u64 lanes[4] = {seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1};
+        for (; bytes + 32 <= end; bytes += 32)
+        {
+            for (u32 lane = 0; lane < 4; lane++) lanes[lane] = round(lanes[lane], read64(bytes + 8 * lane));
+        }
+
+        hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+        for (u64 lane : lanes) hash = merge(hash, lane);
+    }
+    else
+    {
+        hash = seed + Prime5;
+    }
+    hash += size;
+
+    for (; bytes + 8 <= end; bytes += 8)
+    {
+        hash ^= round(0, read64(bytes));
+        hash = rotateLeft(hash, 27) * Prime1 + Prime4;
+    }
+    if (bytes + 4 <= end)
+    {
+        hash ^= read32(bytes) * Prime1;
+        hash = rotateLeft(hash, 23) * Prime2 + Prime3;
+        bytes += 4;
+    }
+    for (; bytes < end; bytes++)
+    {
+        hash ^= *bytes * Prime5;
+        hash = rotateLeft(hash, 11) * Prime1;
+    }
+
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+} // namespace ddls
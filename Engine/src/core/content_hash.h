@@ -0,0 +1,22 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+#include "utils/helper.h"
+
+namespace ddls {
+
+/**
+ * @brief XXH64, a 64-bit non-cryptographic hash running at memory speed
+ * 
+ * Identifies identical contents loaded under different names. Results match the
+ * reference implementation on little-endian machines.
+ * 
+ */
+class DDLS_API ContentHash : public Helper
+{
+public:
+    static u64 Of(const void *data, u64 size, u64 seed = 0);
+};
+
+} // namespace ddls
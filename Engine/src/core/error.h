@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdlib>
 #include <iostream>
 #include <string>
 
+#include "defines.h"
 #include "types.h"
 
 namespace ddls {
@@ -32,4 +34,41 @@ public:
     OutOfBoundsException(std::string msg) : CustomMessageException(msg) {}
 };
 
+/**
+ * @brief Allocation failures, reported by the allocators' non-throwing API
+ * 
+ */
+enum class AllocError : u8
+{
+    OutOfMemory,
+    OutOfBounds,
+    InvalidAlignment
+};
+
+inline const char *describe(AllocError error)
+{
+    switch (error)
+    {
+        case AllocError::OutOfMemory:      return "Out of memory";
+        case AllocError::OutOfBounds:      return "Out of bounds";
+        case AllocError::InvalidAlignment: return "Invalid alignment";
+    }
+    return "Unknown allocation error";
+}
+
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+
+#define DDLS_THROW(exception) throw exception
+
+#else
+
+// Without exceptions, a failure of the throwing API is fatal
+#define DDLS_THROW(exception) \
+    { \
+        std::cerr << #exception << '\n'; \
+        std::abort(); \
+    }
+
+#endif
+
 } // namespace ddls
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "core/assert.h"
+
+#include <type_traits>
+
+namespace ddls {
+
+/**
+ * @brief Wraps an error to construct a failed Expected
+ * 
+ */
+template<typename E>
+struct Unexpected
+{
+    E error;
+};
+
+template<typename E>
+Unexpected(E) -> Unexpected<E>;
+
+/**
+ * @brief Either a value or an error, never allocates nor throws
+ * 
+ * Limited to trivially copyable types, which is all the allocators need.
+ * 
+ * @tparam T The type of the value
+ * @tparam E The type of the error, usually an enum
+ */
+template<typename T, typename E>
+class Expected
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<E>,
+        "Expected only holds trivially copyable types");
+
+public:
+    constexpr Expected(T value) noexcept : _value(value), _hasValue(true) {}
+
+    constexpr Expected(Unexpected<E> unexpected) noexcept : _error(unexpected.error), _hasValue(false) {}
+
+    constexpr bool hasValue() const noexcept { return _hasValue; }
+
+    constexpr explicit operator bool() const noexcept { return _hasValue; }
+
+    constexpr T value() const noexcept
+    {
+        Assert(_hasValue, "Accessing the value of a failed Expected!");
+        return _value;
+    }
+
+    constexpr T valueOr(T fallback) const noexcept { return _hasValue ? _value : fallback; }
+
+    constexpr E error() const noexcept
+    {
+        Assert(!_hasValue, "Accessing the error of a successful Expected!");
+        return _error;
+    }
+
+private:
+    union
+    {
+        T _value;
+        E _error;
+    };
+    bool _hasValue;
+};
+
+/**
+ * @brief Either success or an error
+ * 
+ */
+template<typename E>
+class Expected<void, E>
+{
+public:
+    constexpr Expected() noexcept : _error(), _hasValue(true) {}
+
+    constexpr Expected(Unexpected<E> unexpected) noexcept : _error(unexpected.error), _hasValue(false) {}
+
+    constexpr bool hasValue() const noexcept { return _hasValue; }
+
+    constexpr explicit operator bool() const noexcept { return _hasValue; }
+
+    constexpr E error() const noexcept
+    {
+        Assert(!_hasValue, "Accessing the error of a successful Expected!");
+        return _error;
+    }
+
+private:
+    E _error;
+    bool _hasValue;
+};
+
+} // namespace ddls
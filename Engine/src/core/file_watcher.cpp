@@ -0,0 +1,135 @@
+#include "core/file_watcher.h"
+
+#include "core/log.h"
+
+#ifdef DDLS_PLATFORM_LINUX
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace ddls {
+
+FileWatcher::~FileWatcher()
+{
+    stop();
+}
+
+#ifdef DDLS_PLATFORM_LINUX
+
+Boolean FileWatcher::watch(const std::filesystem::path &root, Callback callback)
+{
+    stop();
+
+    _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    _wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_inotify < 0 || _wake < 0)
+    {
+        Log::Error(LogCategory::Resources, "Cannot start watching \"", root.string(), "\"!");
+        stop();
+        return false;
+    }
+
+    _root = root;
+    _callback = std::move(callback);
+    addDirectory(_root);
+    if (_directories.empty())
+    {
+        Log::Error(LogCategory::Resources, "Cannot watch \"", root.string(), "\"!");
+        stop();
+        return false;
+    }
+
+    std::error_code error;
+    for (auto iterator = std::filesystem::recursive_directory_iterator(_root, error);
+        iterator != std::filesystem::recursive_directory_iterator(); iterator.increment(error))
+    {
+        if (iterator->is_directory(error)) addDirectory(iterator->path());
+    }
+
+    _thread = std::thread(&FileWatcher::run, this);
+
+    return true;
+}
+
+void FileWatcher::stop()
+{
+    if (_thread.joinable())
+    {
+        u64 one = 1;
+        ignore(::write(_wake, &one, sizeof(one)));
+        _thread.join();
+    }
+
+    if (_inotify >= 0) ::close(_inotify);
+    if (_wake >= 0) ::close(_wake);
+    _inotify = -1;
+    _wake = -1;
+    _directories.clear();
+}
+
+void FileWatcher::addDirectory(const std::filesystem::path &directory)
+{
+    int descriptor = inotify_add_watch(_inotify, directory.c_str(),
+        IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+    if (descriptor < 0) return;
+
+    std::string relative = directory.lexically_relative(_root).generic_string();
+    _directories[descriptor] = relative == "." ? std::string() : relative + "/";
+}
+
+void FileWatcher::run()
+{
+    // Large enough for many events at once, aligned for the event structure
+    alignas(inotify_event) char buffer[16 * 1024];
+    pollfd descriptors[2] = {{_inotify, POLLIN, 0}, {_wake, POLLIN, 0}};
+
+    while (true)
+    {
+        if (poll(descriptors, 2, -1) < 0) continue;
+        if (descriptors[1].revents) return;
+
+        ssize_t length;
+        while ((length = ::read(_inotify, buffer, sizeof(buffer))) > 0)
+        {
+            for (char *event = buffer; event < buffer + length;)
+            {
+                const inotify_event *change = (const inotify_event *) event;
+                event += sizeof(inotify_event) + change->len;
+
+                auto directory = _directories.find(change->wd);
+                if (directory == _directories.end() || !change->len) continue;
+                std::string path = directory->second + change->name;
+
+                if (change->mask & IN_ISDIR)
+                {
+                    // New directories are watched, the files written into them will be reported
+                    if (change->mask & (IN_CREATE | IN_MOVED_TO)) addDirectory(_root / path);
+                }
+                else if (change->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                {
+                    _callback(path);
+                }
+            }
+        }
+    }
+}
+
+#else
+
+Boolean FileWatcher::watch(const std::filesystem::path &root, Callback callback)
+{
+    ignore(callback);
+    Log::Warning(LogCategory::Resources, "Cannot watch \"", root.string(), "\", file watching is only supported on Linux");
+
+    return false;
+}
+
+void FileWatcher::stop()
+{
+}
+
+#endif
+
+} // namespace ddls
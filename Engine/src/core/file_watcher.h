@@ -0,0 +1,72 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+#include "core/error.h"
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace ddls {
+
+/**
+ * @brief Watches a directory tree and reports the files written into it
+ * 
+ * Changes are reported from a dedicated thread once a file is closed after writing
+ * or moved into the tree, so editors saving through a temporary file are caught too.
+ * Only implemented with inotify on Linux, watch() fails elsewhere.
+ * 
+ */
+class DDLS_API FileWatcher
+{
+public:
+    /**
+     * @brief Called from the watching thread with the path relative to the root, '/' separated
+     * 
+     */
+    using Callback = std::function<void(const std::string &path)>;
+
+    FileWatcher() = default;
+
+    /**
+     * @brief Stops watching
+     * 
+     */
+    ~FileWatcher();
+
+    FileWatcher(FileWatcher const&)     = delete;
+    void operator=(FileWatcher const&)  = delete;
+
+    /**
+     * @brief Starts watching every directory under root, including those created later
+     * 
+     * @return false if watching is unsupported or root cannot be watched
+     */
+    Boolean watch(const std::filesystem::path &root, Callback callback);
+
+    /**
+     * @brief Stops watching, waiting for a running callback to return
+     * 
+     */
+    void stop();
+
+    Boolean isWatching() const { return _thread.joinable(); }
+
+private:
+    void run();
+    void addDirectory(const std::filesystem::path &directory);
+
+    std::filesystem::path _root;
+    Callback _callback;
+    std::thread _thread;
+    int _inotify = -1;
+    // Written to wake the watching thread up when stopping
+    int _wake = -1;
+    // Watch descriptors to the directory they watch, relative to the root
+    std::unordered_map<int, std::string> _directories;
+};
+
+} // namespace ddls
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+#include "core/error.h"
+#include "core/memory.h"
+
+#include <functional>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ddls {
+
+/**
+ * @brief An open-addressing hash map with linear probing
+ *
+ * Entries live in a single contiguous array accounted under a memory tag,
+ * lookups walk it from the key's slot without following any pointer.
+ * Erasing shifts the following entries back, so there are no tombstones.
+ * Pointers to values are invalidated when the map grows or an entry is erased.
+ *
+ * @tparam Key The key type, equality comparable
+ * @tparam Value The mapped type
+ * @tparam Hash A hash functor, its result is scrambled so identity hashes are fine
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class HashMap
+{
+public:
+    using Entry = std::pair<Key, Value>;
+
+    static_assert(alignof(Entry) <= DefaultAlignment, "HashMap entries are over-aligned");
+
+    static constexpr u64 MinCapacity = 16;
+
+    template<bool Const>
+    class Iterator
+    {
+    public:
+        using Map = std::conditional_t<Const, const HashMap, HashMap>;
+        using Reference = std::conditional_t<Const, const Entry &, Entry &>;
+        using Pointer = std::conditional_t<Const, const Entry *, Entry *>;
+
+        Iterator(Map *map, u64 slot) : _map(map), _slot(slot) { skip(); }
+
+        Reference operator*() const { return _map->_entries[_slot]; }
+
+        Pointer operator->() const { return &_map->_entries[_slot]; }
+
+        Iterator &operator++()
+        {
+            _slot++;
+            skip();
+            return *this;
+        }
+
+        bool operator==(const Iterator &other) const { return _slot == other._slot; }
+
+    private:
+        void skip()
+        {
+            while (_slot < _map->_capacity && !_map->_occupied[_slot]) _slot++;
+        }
+
+        Map *_map;
+        u64 _slot;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    explicit HashMap(MemoryTag tag = MemoryTag::Miscellaneous) : _tag(tag) {}
+
+    ~HashMap()
+    {
+        clear();
+        Memory::Free(_entries);
+        Memory::Free(_occupied);
+    }
+
+    HashMap(const HashMap &) = delete;
+    HashMap &operator=(const HashMap &) = delete;
+
+    HashMap(HashMap &&other) noexcept : _tag(other._tag) { swap(other); }
+
+    HashMap &operator=(HashMap &&other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    /**
+     * @brief Finds the value of a key
+     *
+     * @return Value* nullptr if the key is absent
+     */
+    Value *find(const Key &key)
+    {
+        u64 slot = findSlot(key);
+        return slot == _capacity ? nullptr : &_entries[slot].second;
+    }
+
+    const Value *find(const Key &key) const
+    {
+        u64 slot = findSlot(key);
+        return slot == _capacity ? nullptr : &_entries[slot].second;
+    }
+
+    bool contains(const Key &key) const { return findSlot(key) != _capacity; }
+
+    /**
+     * @brief Constructs a value for the key if it is absent
+     *
+     * @return The value of the key and whether it was inserted
+     */
+    template<typename... Args>
+    std::pair<Value *, bool> tryEmplace(const Key &key, Args &&...args)
+    {
+        if (Value *value = find(key)) return {value, false};
+
+        if ((_size + 1) * 4 > _capacity * 3) grow(_capacity ? _capacity * 2 : MinCapacity);
+        u64 slot = home(key);
+        while (_occupied[slot]) slot = (slot + 1) & (_capacity - 1);
+
+        new (&_entries[slot]) Entry(std::piecewise_construct,
+            std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        _occupied[slot] = 1;
+        _size++;
+
+        return {&_entries[slot].second, true};
+    }
+
+    /**
+     * @brief Gets the value of a key, default constructing it if absent
+     *
+     */
+    Value &operator[](const Key &key) { return *tryEmplace(key).first; }
+
+    /**
+     * @brief Removes a key
+     *
+     * @return false if the key was absent
+     */
+    bool erase(const Key &key)
+    {
+        u64 hole = findSlot(key);
+        if (hole == _capacity) return false;
+
+        // Shift back every following entry of the cluster that would otherwise become unreachable
+        u64 mask = _capacity - 1;
+        for (u64 slot = (hole + 1) & mask; _occupied[slot]; slot = (slot + 1) & mask)
+        {
+            u64 wanted = home(_entries[slot].first);
+            // The entry may fill the hole if its home isn't cyclically within (hole, slot]
+            if (((slot - wanted) & mask) >= ((slot - hole) & mask))
+            {
+                _entries[hole] = std::move(_entries[slot]);
+                hole = slot;
+            }
+        }
+
+        _entries[hole].~Entry();
+        _occupied[hole] = 0;
+        _size--;
+
+        return true;
+    }
+
+    /**
+     * @brief Destroys every entry, keeping the capacity
+     *
+     */
+    void clear()
+    {
+        for (u64 slot = 0; slot < _capacity; slot++)
+        {
+            if (!_occupied[slot]) continue;
+            _entries[slot].~Entry();
+            _occupied[slot] = 0;
+        }
+        _size = 0;
+    }
+
+    /**
+     * @brief Makes room for count entries without growing
+     *
+     */
+    void reserve(u64 count)
+    {
+        u64 capacity = _capacity ? _capacity : MinCapacity;
+        while (count * 4 > capacity * 3) capacity *= 2;
+        if (capacity != _capacity) grow(capacity);
+    }
+
+    u64 size() const { return _size; }
+
+    u64 capacity() const { return _capacity; }
+
+    bool empty() const { return _size == 0; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, _capacity); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, _capacity); }
+
+private:
+    u64 home(const Key &key) const
+    {
+        // Fibonacci hashing spreads weak hashes over the high bits
+        return ((u64) Hash{}(key) * 11400714819323198485ull) >> _shift;
+    }
+
+    u64 findSlot(const Key &key) const
+    {
+        if (!_size) return _capacity;
+
+        for (u64 slot = home(key); _occupied[slot]; slot = (slot + 1) & (_capacity - 1))
+        {
+            if (_entries[slot].first == key) return slot;
+        }
+        return _capacity;
+    }
+
+    void grow(u64 capacity)
+    {
+        Entry *entries = (Entry *) Memory::Allocate(capacity * sizeof(Entry), _tag);
+        u8 *occupied = (u8 *) Memory::Allocate(capacity, _tag);
+        if (!entries || !occupied) DDLS_THROW(OutOfMemoryException("Failed to grow hash map!"));
+        for (u64 slot = 0; slot < capacity; slot++) occupied[slot] = 0;
+
+        Entry *oldEntries = _entries;
+        u8 *oldOccupied = _occupied;
+        u64 oldCapacity = _capacity;
+
+        _entries = entries;
+        _occupied = occupied;
+        _capacity = capacity;
+        _shift = 64;
+        for (u64 bits = capacity; bits > 1; bits >>= 1) _shift--;
+
+        for (u64 slot = 0; slot < oldCapacity; slot++)
+        {
+            if (!oldOccupied[slot]) continue;
+            u64 target = home(oldEntries[slot].first);
+            while (_occupied[target]) target = (target + 1) & (_capacity - 1);
+            new (&_entries[target]) Entry(std::move(oldEntries[slot]));
+            _occupied[target] = 1;
+            oldEntries[slot].~Entry();
+        }
+
+        Memory::Free(oldEntries);
+        Memory::Free(oldOccupied);
+    }
+
+    void swap(HashMap &other) noexcept
+    {
+        std::swap(_entries, other._entries);
+        std::swap(_occupied, other._occupied);
+        std::swap(_capacity, other._capacity);
+        std::swap(_size, other._size);
+        std::swap(_shift, other._shift);
+        std::swap(_tag, other._tag);
+    }
+
+    Entry *_entries = nullptr;
+    u8 *_occupied = nullptr;
+    u64 _capacity = 0;
+    u64 _size = 0;
+    u32 _shift = 64;
+    MemoryTag _tag;
+};
+
+} // namespace ddls
@@ -0,0 +1,566 @@
+#include "core/image.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DDLS_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC compiles intrinsics of any instruction set without enabling it for the whole file
+#define DDLS_TARGET_AVX2
+#else
+#define DDLS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DDLS_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace ddls {
+
+/**
+ * @brief The kernels of an instruction set, whole images are split around them
+ * 
+ */
+struct Kernels
+{
+    void (*expandRgbToRgba)(const u8 *source, u8 *destination, u64 pixelCount);
+    void (*swapRows)(u8 *first, u8 *second, u64 size);
+    void (*premultiplyRgba)(u8 *pixels, u64 pixelCount);
+    void (*linearToSrgb)(const f32 *source, u8 *destination, u64 count);
+    // Averages pixel pairs of two rows, outputCount pairs
+    void (*downsampleRgba)(const u8 *top, const u8 *bottom, u8 *destination, u64 outputCount);
+};
+
+/**
+ * @brief Conversion tables, built on first use
+ * 
+ */
+struct SrgbTables
+{
+    static constexpr u32 LinearSteps = 4095;
+
+    f32 toLinear[256];
+    u8 toSrgb[LinearSteps + 1];
+
+    SrgbTables()
+    {
+        for (u32 value = 0; value < 256; value++)
+        {
+            f64 srgb = value / 255.0;
+            toLinear[value] = (f32) (srgb <= 0.04045 ? srgb / 12.92 : std::pow((srgb + 0.055) / 1.055, 2.4));
+        }
+        for (u32 step = 0; step <= LinearSteps; step++)
+        {
+            f64 linear = (f64) step / LinearSteps;
+            f64 srgb = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+            toSrgb[step] = (u8) std::lround(srgb * 255.0);
+        }
+    }
+};
+
+static const SrgbTables &srgbTables()
+{
+    static const SrgbTables tables;
+    return tables;
+}
+
+// Rounds c * a / 255 to nearest, the SIMD kernels compute ((x + 128) + ((x + 128) >> 8)) >> 8 which is the same
+static u8 multiplyAlpha(u32 color, u32 alpha)
+{
+    return (u8) ((color * alpha + 127) / 255);
+}
+
+static void expandRgbToRgbaScalar(const u8 *source, u8 *destination, u64 pixelCount)
+{
+    for (u64 i = 0; i < pixelCount; i++)
+    {
+        destination[4 * i] = source[3 * i];
+        destination[4 * i + 1] = source[3 * i + 1];
+        destination[4 * i + 2] = source[3 * i + 2];
+        destination[4 * i + 3] = 0xFF;
+    }
+}
+
+static void swapRowsScalar(u8 *first, u8 *second, u64 size)
+{
+    std::swap_ranges(first, first + size, second);
+}
+
+static void premultiplyRgbaScalar(u8 *pixels, u64 pixelCount)
+{
+    for (u64 i = 0; i < pixelCount; i++, pixels += 4)
+    {
+        for (u32 c = 0; c < 3; c++) pixels[c] = multiplyAlpha(pixels[c], pixels[3]);
+    }
+}
+
+// NaN is clamped to 0, like the SIMD kernels' max
+static u32 linearStep(f32 linear)
+{
+    linear = linear > 0.0f ? (linear < 1.0f ? linear : 1.0f) : 0.0f;
+    // Rounds half to even like the SIMD conversions, the product alone is rounded once everywhere
+    return (u32) std::nearbyint(linear * (f32) SrgbTables::LinearSteps);
+}
+
+static void linearToSrgbScalar(const f32 *source, u8 *destination, u64 count)
+{
+    const SrgbTables &tables = srgbTables();
+    for (u64 i = 0; i < count; i++) destination[i] = tables.toSrgb[linearStep(source[i])];
+}
+
+static void downsampleRgbaScalar(const u8 *top, const u8 *bottom, u8 *destination, u64 outputCount)
+{
+    for (u64 i = 0; i < outputCount * 4; i++)
+    {
+        u64 left = (i / 4) * 8 + i % 4;
+        u32 sum = (u32) top[left] + top[left + 4] + bottom[left] + bottom[left + 4];
+        destination[i] = (u8) ((sum + 2) / 4);
+    }
+}
+
+static const Kernels ScalarKernels{
+    expandRgbToRgbaScalar, swapRowsScalar, premultiplyRgbaScalar, linearToSrgbScalar, downsampleRgbaScalar
+};
+
+#ifdef DDLS_SIMD_X86
+
+// SSE2 has no byte shuffle, the scalar expansion is as fast as shifting the pixels apart
+static void swapRowsSse2(u8 *first, u8 *second, u64 size)
+{
+    u64 i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *) (first + i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (second + i));
+        _mm_storeu_si128((__m128i *) (first + i), b);
+        _mm_storeu_si128((__m128i *) (second + i), a);
+    }
+    swapRowsScalar(first + i, second + i, size - i);
+}
+
+static __m128i multiplyAlphaSse2(__m128i colors)
+{
+    // Every 16-bit lane times the alpha of its pixel, lane 3 of each half
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(colors, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i product = _mm_add_epi16(_mm_mullo_epi16(colors, alpha), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+}
+
+static void premultiplyRgbaSse2(u8 *pixels, u64 pixelCount)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = _mm_set1_epi32((i32) 0xFF000000);
+    u64 i = 0;
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        __m128i rgba = _mm_loadu_si128((const __m128i *) (pixels + 4 * i));
+        __m128i low = multiplyAlphaSse2(_mm_unpacklo_epi8(rgba, zero));
+        __m128i high = multiplyAlphaSse2(_mm_unpackhi_epi8(rgba, zero));
+        __m128i premultiplied = _mm_packus_epi16(low, high);
+        premultiplied = _mm_or_si128(_mm_andnot_si128(alphaMask, premultiplied), _mm_and_si128(rgba, alphaMask));
+        _mm_storeu_si128((__m128i *) (pixels + 4 * i), premultiplied);
+    }
+    premultiplyRgbaScalar(pixels + 4 * i, pixelCount - i);
+}
+
+static void linearToSrgbSse2(const f32 *source, u8 *destination, u64 count)
+{
+    const SrgbTables &tables = srgbTables();
+    const __m128 steps = _mm_set1_ps((f32) SrgbTables::LinearSteps);
+    alignas(16) i32 indices[4];
+    u64 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        // max returns its second operand for NaN
+        __m128 linear = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        _mm_store_si128((__m128i *) indices, _mm_cvtps_epi32(_mm_mul_ps(linear, steps)));
+        for (u32 lane = 0; lane < 4; lane++) destination[i + lane] = tables.toSrgb[indices[lane]];
+    }
+    linearToSrgbScalar(source + i, destination + i, count - i);
+}
+
+static void downsampleRgbaSse2(const u8 *top, const u8 *bottom, u8 *destination, u64 outputCount)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    u64 i = 0;
+    for (; i + 2 <= outputCount; i += 2)
+    {
+        __m128i upper = _mm_loadu_si128((const __m128i *) (top + 8 * i));
+        __m128i lower = _mm_loadu_si128((const __m128i *) (bottom + 8 * i));
+        // Pixels 0 and 1, then 2 and 3, summed vertically
+        __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+        __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+        // Then horizontally, 0 + 1 and 2 + 3
+        __m128i sums = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+        sums = _mm_srli_epi16(_mm_add_epi16(sums, two), 2);
+        _mm_storel_epi64((__m128i *) (destination + 4 * i), _mm_packus_epi16(sums, sums));
+    }
+    downsampleRgbaScalar(top + 8 * i, bottom + 8 * i, destination + 4 * i, outputCount - i);
+}
+
+static const Kernels Sse2Kernels{
+    expandRgbToRgbaScalar, swapRowsSse2, premultiplyRgbaSse2, linearToSrgbSse2, downsampleRgbaSse2
+};
+
+DDLS_TARGET_AVX2 static void expandRgbToRgbaAvx2(const u8 *source, u8 *destination, u64 pixelCount)
+{
+    // Each lane spreads 4 pixels out of its first 12 bytes, leaving room for the alpha
+    const __m256i spread = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32((i32) 0xFF000000);
+    u64 i = 0;
+    // The second lane reads 16 bytes from pixel i + 4, 4 bytes past the 8 pixels
+    for (; i + 10 <= pixelCount; i += 8)
+    {
+        __m256i rgb = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) (source + 3 * i))),
+            _mm_loadu_si128((const __m128i *) (source + 3 * i + 12)), 1);
+        _mm256_storeu_si256((__m256i *) (destination + 4 * i), _mm256_or_si256(_mm256_shuffle_epi8(rgb, spread), alpha));
+    }
+    expandRgbToRgbaScalar(source + 3 * i, destination + 4 * i, pixelCount - i);
+}
+
+DDLS_TARGET_AVX2 static void swapRowsAvx2(u8 *first, u8 *second, u64 size)
+{
+    u64 i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (first + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (second + i));
+        _mm256_storeu_si256((__m256i *) (first + i), b);
+        _mm256_storeu_si256((__m256i *) (second + i), a);
+    }
+    swapRowsSse2(first + i, second + i, size - i);
+}
+
+DDLS_TARGET_AVX2 static __m256i multiplyAlphaAvx2(__m256i colors)
+{
+    __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(colors, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(colors, alpha), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+}
+
+DDLS_TARGET_AVX2 static void premultiplyRgbaAvx2(u8 *pixels, u64 pixelCount)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaMask = _mm256_set1_epi32((i32) 0xFF000000);
+    u64 i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        // Unpacking and packing both work within lanes, so the pixels stay in order
+        __m256i rgba = _mm256_loadu_si256((const __m256i *) (pixels + 4 * i));
+        __m256i low = multiplyAlphaAvx2(_mm256_unpacklo_epi8(rgba, zero));
+        __m256i high = multiplyAlphaAvx2(_mm256_unpackhi_epi8(rgba, zero));
+        __m256i premultiplied = _mm256_packus_epi16(low, high);
+        premultiplied = _mm256_or_si256(_mm256_andnot_si256(alphaMask, premultiplied), _mm256_and_si256(rgba, alphaMask));
+        _mm256_storeu_si256((__m256i *) (pixels + 4 * i), premultiplied);
+    }
+    premultiplyRgbaSse2(pixels + 4 * i, pixelCount - i);
+}
+
+DDLS_TARGET_AVX2 static void linearToSrgbAvx2(const f32 *source, u8 *destination, u64 count)
+{
+    const SrgbTables &tables = srgbTables();
+    const __m256 steps = _mm256_set1_ps((f32) SrgbTables::LinearSteps);
+    alignas(32) i32 indices[8];
+    u64 i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 linear = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(source + i), _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        _mm256_store_si256((__m256i *) indices, _mm256_cvtps_epi32(_mm256_mul_ps(linear, steps)));
+        for (u32 lane = 0; lane < 8; lane++) destination[i + lane] = tables.toSrgb[indices[lane]];
+    }
+    linearToSrgbSse2(source + i, destination + i, count - i);
+}
+
+DDLS_TARGET_AVX2 static void downsampleRgbaAvx2(const u8 *top, const u8 *bottom, u8 *destination, u64 outputCount)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i two = _mm256_set1_epi16(2);
+    u64 i = 0;
+    for (; i + 4 <= outputCount; i += 4)
+    {
+        __m256i upper = _mm256_loadu_si256((const __m256i *) (top + 8 * i));
+        __m256i lower = _mm256_loadu_si256((const __m256i *) (bottom + 8 * i));
+        // As with SSE2 within each lane, pixels 0 to 3 then 4 to 7
+        __m256i low = _mm256_add_epi16(_mm256_unpacklo_epi8(upper, zero), _mm256_unpacklo_epi8(lower, zero));
+        __m256i high = _mm256_add_epi16(_mm256_unpackhi_epi8(upper, zero), _mm256_unpackhi_epi8(lower, zero));
+        __m256i sums = _mm256_add_epi16(_mm256_unpacklo_epi64(low, high), _mm256_unpackhi_epi64(low, high));
+        sums = _mm256_srli_epi16(_mm256_add_epi16(sums, two), 2);
+        // Each lane packed its 2 pixels in its low half, gathered into the low lane
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(sums, sums), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i *) (destination + 4 * i), _mm256_castsi256_si128(packed));
+    }
+    downsampleRgbaSse2(top + 8 * i, bottom + 8 * i, destination + 4 * i, outputCount - i);
+}
+
+static const Kernels Avx2Kernels{
+    expandRgbToRgbaAvx2, swapRowsAvx2, premultiplyRgbaAvx2, linearToSrgbAvx2, downsampleRgbaAvx2
+};
+
+#endif
+
+#ifdef DDLS_SIMD_NEON
+
+static void expandRgbToRgbaNeon(const u8 *source, u8 *destination, u64 pixelCount)
+{
+    u64 i = 0;
+    for (; i + 16 <= pixelCount; i += 16)
+    {
+        uint8x16x3_t rgb = vld3q_u8(source + 3 * i);
+        uint8x16x4_t rgba = {{rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(0xFF)}};
+        vst4q_u8(destination + 4 * i, rgba);
+    }
+    expandRgbToRgbaScalar(source + 3 * i, destination + 4 * i, pixelCount - i);
+}
+
+static void swapRowsNeon(u8 *first, u8 *second, u64 size)
+{
+    u64 i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        uint8x16_t a = vld1q_u8(first + i);
+        uint8x16_t b = vld1q_u8(second + i);
+        vst1q_u8(first + i, b);
+        vst1q_u8(second + i, a);
+    }
+    swapRowsScalar(first + i, second + i, size - i);
+}
+
+static uint8x16_t multiplyAlphaNeon(uint8x16_t colors, uint8x16_t alpha)
+{
+    uint16x8_t low = vmull_u8(vget_low_u8(colors), vget_low_u8(alpha));
+    uint16x8_t high = vmull_u8(vget_high_u8(colors), vget_high_u8(alpha));
+    // (x + ((x + 128) >> 8) + 128) >> 8
+    return vcombine_u8(vraddhn_u16(low, vrshrq_n_u16(low, 8)), vraddhn_u16(high, vrshrq_n_u16(high, 8)));
+}
+
+static void premultiplyRgbaNeon(u8 *pixels, u64 pixelCount)
+{
+    u64 i = 0;
+    for (; i + 16 <= pixelCount; i += 16)
+    {
+        uint8x16x4_t rgba = vld4q_u8(pixels + 4 * i);
+        for (u32 c = 0; c < 3; c++) rgba.val[c] = multiplyAlphaNeon(rgba.val[c], rgba.val[3]);
+        vst4q_u8(pixels + 4 * i, rgba);
+    }
+    premultiplyRgbaScalar(pixels + 4 * i, pixelCount - i);
+}
+
+static void linearToSrgbNeon(const f32 *source, u8 *destination, u64 count)
+{
+    const SrgbTables &tables = srgbTables();
+    u32 indices[4];
+    u64 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        // maxnm returns the number for NaN
+        float32x4_t linear = vminq_f32(vmaxnmq_f32(vld1q_f32(source + i), vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+        vst1q_u32(indices, vcvtnq_u32_f32(vmulq_n_f32(linear, (f32) SrgbTables::LinearSteps)));
+        for (u32 lane = 0; lane < 4; lane++) destination[i + lane] = tables.toSrgb[indices[lane]];
+    }
+    linearToSrgbScalar(source + i, destination + i, count - i);
+}
+
+static void downsampleRgbaNeon(const u8 *top, const u8 *bottom, u8 *destination, u64 outputCount)
+{
+    u64 i = 0;
+    for (; i + 8 <= outputCount; i += 8)
+    {
+        uint8x16x4_t upper = vld4q_u8(top + 8 * i);
+        uint8x16x4_t lower = vld4q_u8(bottom + 8 * i);
+        uint8x8x4_t averaged;
+        for (u32 c = 0; c < 4; c++)
+        {
+            // Adjacent pixels added pairwise, then the lower row accumulated onto them
+            uint16x8_t sums = vpadalq_u8(vpaddlq_u8(upper.val[c]), lower.val[c]);
+            averaged.val[c] = vrshrn_n_u16(sums, 2);
+        }
+        vst4_u8(destination + 4 * i, averaged);
+    }
+    downsampleRgbaScalar(top + 8 * i, bottom + 8 * i, destination + 4 * i, outputCount - i);
+}
+
+static const Kernels NeonKernels{
+    expandRgbToRgbaNeon, swapRowsNeon, premultiplyRgbaNeon, linearToSrgbNeon, downsampleRgbaNeon
+};
+
+#endif
+
+static const Kernels &kernelsOf(SimdLevel level)
+{
+    switch (level)
+    {
+#ifdef DDLS_SIMD_X86
+        case SimdLevel::Sse2: return Sse2Kernels;
+        case SimdLevel::Avx2: return Avx2Kernels;
+#endif
+#ifdef DDLS_SIMD_NEON
+        case SimdLevel::Neon: return NeonKernels;
+#endif
+        default: return ScalarKernels;
+    }
+}
+
+static SimdLevel &currentLevel()
+{
+    static SimdLevel level = Image::BestLevel();
+    return level;
+}
+
+static const Kernels &kernels()
+{
+    return kernelsOf(currentLevel());
+}
+
+void Image::ExpandRgbToRgba(const u8 *source, u8 *destination, u64 pixelCount)
+{
+    kernels().expandRgbToRgba(source, destination, pixelCount);
+}
+
+void Image::FlipVertically(u8 *pixels, u64 rowSize, u32 height)
+{
+    const Kernels &active = kernels();
+    for (u32 row = 0; row < height / 2; row++)
+    {
+        active.swapRows(pixels + row * rowSize, pixels + (height - 1 - row) * rowSize, rowSize);
+    }
+}
+
+void Image::Premultiply(u8 *pixels, u64 pixelCount, u16 channels)
+{
+    if (channels == 4)
+    {
+        kernels().premultiplyRgba(pixels, pixelCount);
+    }
+    else if (channels == 2)
+    {
+        // Grey and alpha, too rare to warrant its own kernels
+        for (u64 i = 0; i < pixelCount; i++) pixels[2 * i] = multiplyAlpha(pixels[2 * i], pixels[2 * i + 1]);
+    }
+}
+
+void Image::SrgbToLinear(const u8 *source, f32 *destination, u64 count)
+{
+    // A table lookup per value, which no arithmetic approximation beats
+    const SrgbTables &tables = srgbTables();
+    for (u64 i = 0; i < count; i++) destination[i] = tables.toLinear[source[i]];
+}
+
+void Image::LinearToSrgb(const f32 *source, u8 *destination, u64 count)
+{
+    kernels().linearToSrgb(source, destination, count);
+}
+
+void Image::Downsample(const u8 *source, u16 width, u16 height, u16 channels, u8 *destination)
+{
+    u16 halfWidth = std::max<u16>((u16) (width / 2), 1);
+    u16 halfHeight = std::max<u16>((u16) (height / 2), 1);
+    u64 pitch = (u64) width * channels;
+    // A single column is averaged with itself, which the pairwise kernels can't do
+    Boolean vectorized = channels == 4 && width > 1;
+
+    for (u16 y = 0; y < halfHeight; y++)
+    {
+        const u8 *top = source + std::min<u64>(2u * y, height - 1u) * pitch;
+        const u8 *bottom = source + std::min<u64>(2u * y + 1u, height - 1u) * pitch;
+        if (vectorized)
+        {
+            kernels().downsampleRgba(top, bottom, destination, halfWidth);
+            destination += (u64) halfWidth * 4;
+            continue;
+        }
+
+        for (u16 x = 0; x < halfWidth; x++)
+        {
+            u64 left = std::min<u64>(2u * x, width - 1u) * channels;
+            u64 right = std::min<u64>(2u * x + 1u, width - 1u) * channels;
+            for (u16 c = 0; c < channels; c++)
+            {
+                u32 sum = (u32) top[left + c] + top[right + c] + bottom[left + c] + bottom[right + c];
+                *destination++ = (u8) ((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+void Image::Downsample(const f32 *source, u16 width, u16 height, u16 channels, f32 *destination)
+{
+    u16 halfWidth = std::max<u16>((u16) (width / 2), 1);
+    u16 halfHeight = std::max<u16>((u16) (height / 2), 1);
+    u64 pitch = (u64) width * channels;
+
+    for (u16 y = 0; y < halfHeight; y++)
+    {
+        const f32 *top = source + std::min<u64>(2u * y, height - 1u) * pitch;
+        const f32 *bottom = source + std::min<u64>(2u * y + 1u, height - 1u) * pitch;
+        for (u16 x = 0; x < halfWidth; x++)
+        {
+            u64 left = std::min<u64>(2u * x, width - 1u) * channels;
+            u64 right = std::min<u64>(2u * x + 1u, width - 1u) * channels;
+            for (u16 c = 0; c < channels; c++)
+            {
+                *destination++ = (top[left + c] + top[right + c] + bottom[left + c] + bottom[right + c]) * 0.25f;
+            }
+        }
+    }
+}
+
+SimdLevel Image::BestLevel()
+{
+#if defined(DDLS_SIMD_X86) && defined(_MSC_VER)
+    int registers[4];
+    __cpuid(registers, 0);
+    if (registers[0] >= 7)
+    {
+        __cpuidex(registers, 7, 0);
+        Boolean avx2 = (registers[1] & (1 << 5)) != 0;
+        __cpuid(registers, 1);
+        // The OS must save the AVX registers too
+        Boolean osSaves = (registers[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        if (avx2 && osSaves) return SimdLevel::Avx2;
+    }
+    return SimdLevel::Sse2;
+#elif defined(DDLS_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::Sse2;
+    return SimdLevel::Scalar;
+#elif defined(DDLS_SIMD_NEON)
+    // Part of every AArch64 CPU
+    return SimdLevel::Neon;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+Boolean Image::IsSupported(SimdLevel level)
+{
+    SimdLevel best = BestLevel();
+    switch (level)
+    {
+        case SimdLevel::Scalar: return true;
+        case SimdLevel::Sse2: return best == SimdLevel::Sse2 || best == SimdLevel::Avx2;
+        default: return level == best;
+    }
+}
+
+SimdLevel Image::Level()
+{
+    return currentLevel();
+}
+
+Boolean Image::SetLevel(SimdLevel level)
+{
+    if (!IsSupported(level)) return false;
+    currentLevel() = level;
+
+    return true;
+}
+
+} // namespace ddls
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+#include "core/error.h"
+#include "utils/helper.h"
+
+namespace ddls {
+
+/**
+ * @brief The instruction sets the image kernels are written for
+ * 
+ */
+enum class SimdLevel : u8
+{
+    Scalar,
+    Sse2,
+    Avx2,
+    Neon
+};
+
+/**
+ * @brief Pixel processing kernels for 8-bit images, as decoded or cooked
+ * 
+ * Every kernel has a scalar version and SSE2, AVX2 or NEON ones, picked once from what
+ * the CPU supports, and all of them produce the same bytes.
+ * 
+ */
+class DDLS_API Image : public Helper
+{
+public:
+    /**
+     * @brief Adds an opaque alpha to RGB pixels, source and destination must not overlap
+     * 
+     */
+    static void ExpandRgbToRgba(const u8 *source, u8 *destination, u64 pixelCount);
+
+    /**
+     * @brief Swaps the rows of an image in place, top to bottom
+     * 
+     */
+    static void FlipVertically(u8 *pixels, u64 rowSize, u32 height);
+
+    /**
+     * @brief Multiplies the colors by the alpha, the last of 2 or 4 channels, rounding to nearest
+     * 
+     */
+    static void Premultiply(u8 *pixels, u64 pixelCount, u16 channels);
+
+    /**
+     * @brief Decodes sRGB values to linear floats in [0, 1]
+     * 
+     */
+    static void SrgbToLinear(const u8 *source, f32 *destination, u64 count);
+
+    /**
+     * @brief Encodes linear floats to sRGB values, clamping them to [0, 1] first
+     * 
+     * Linear values are quantized to 12 bits, which keeps every result within one of the exact one.
+     */
+    static void LinearToSrgb(const f32 *source, u8 *destination, u64 count);
+
+    /**
+     * @brief Averages 2x2 blocks into a tightly packed image of half the size, at least 1x1
+     * 
+     * An odd last column or row is dropped, the single column or row of a 1 pixel wide
+     * or tall image is averaged with itself.
+     */
+    static void Downsample(const u8 *source, u16 width, u16 height, u16 channels, u8 *destination);
+
+    /**
+     * @brief Averages 2x2 blocks of float texels, like the 8-bit Downsample(), for linear colors
+     * 
+     */
+    static void Downsample(const f32 *source, u16 width, u16 height, u16 channels, f32 *destination);
+
+    /**
+     * @brief The widest instruction set this CPU supports
+     * 
+     */
+    static SimdLevel BestLevel();
+
+    static Boolean IsSupported(SimdLevel level);
+
+    /**
+     * @brief The instruction set the kernels currently run with
+     * 
+     */
+    static SimdLevel Level();
+
+    /**
+     * @brief Runs the kernels with another supported instruction set, to compare them
+     * 
+     * Not thread-safe, meant for tests and benchmarks.
+     * 
+     * @return false if the CPU doesn't support it
+     */
+    static Boolean SetLevel(SimdLevel level);
+};
+
+} // namespace ddls
@@ -1,20 +1,368 @@
 #include "core/log.h"
 
+#include "core/memory.h"
+#include "core/mpsc_queue.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
 namespace ddls {
 
 std::mutex Log::WriteMutex;
 std::ofstream Log::FileStream;
+std::atomic<bool> Log::Tracing{false};
+// Zero is LogLevel::Debug, every category writes what is compiled in
+std::atomic<LogLevel> Log::Levels[(u8) LogCategory::Count]{};
+
+// Guarded by WriteMutex, every format is kept to start the trace logs opened later with
+static std::ofstream TraceStream;
+static std::vector<std::string> TraceFormats;
+
+// Constant-initialized, so that they can still be checked once the writer is destroyed at exit
+static std::atomic<Log::Overflow> OverflowPolicy{Log::Overflow::Block};
+static std::atomic<bool> WriterStopped{false};
+
+/**
+ * @brief What a queued record holds, past its first byte
+ * 
+ */
+enum class Queued : u8
+{
+    Text,
+    // A trace log record, written as is
+    Trace
+};
+
+/**
+ * @brief Drains the queued messages into the log streams on its own thread
+ * 
+ */
+class LogWriter
+{
+public:
+    // 256 KiB of messages, the longest one may take it all
+    static constexpr u64 QueueCells = 4096;
+
+    LogWriter() : _record((char *) Memory::Allocate(_queue.maxRecordSize(), MemoryTag::Logging))
+    {
+        _thread = std::thread([this] { run(); });
+    }
+
+    ~LogWriter()
+    {
+        // Later messages, such as the leak report, are written by their own thread
+        WriterStopped.store(true);
+        _stopping.store(true);
+        wake();
+        _thread.join();
+
+        Memory::Free(_record);
+    }
+
+    LogWriter(const LogWriter &) = delete;
+    LogWriter &operator=(const LogWriter &) = delete;
+
+    static LogWriter &Instance()
+    {
+        // Started by the first message rather than at load time
+        static LogWriter writer;
+
+        return writer;
+    }
+
+    void push(Queued kind, std::span<const char> payload, Log::Overflow overflow)
+    {
+        std::span<const char> parts[2] = {{(const char *) &kind, 1}, payload.first(std::min<u64>(payload.size(), _queue.maxRecordSize() - 1))};
+        if (overflow == Log::Overflow::Drop)
+        {
+            if (!_queue.tryPush({parts[0], parts[1]})) _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        while (!_queue.tryPush({parts[0], parts[1]})) std::this_thread::yield();
+    }
+
+    void flush()
+    {
+        // Everything reserved before now, whichever thread is still copying it
+        u64 target = _queue.tail();
+        wake();
+
+        u64 flushed = _flushed.load(std::memory_order_acquire);
+        while (flushed < target)
+        {
+            _flushed.wait(flushed, std::memory_order_acquire);
+            flushed = _flushed.load(std::memory_order_acquire);
+        }
+    }
+
+private:
+    void wake()
+    {
+        // Empty records aren't written, they only get the writer out of waiting
+        while (!_queue.tryPush(nullptr, 0)) std::this_thread::yield();
+    }
+
+    void run()
+    {
+        u64 reported = 0;
+        while (true)
+        {
+            _queue.wait();
+
+            // A batch at a time, so that flushing never waits on the messages logged after it
+            u64 end = _queue.tail();
+            while (_queue.head() < end)
+            {
+                i64 size = _queue.tryPop(_record);
+                // A producer is still copying a record of the batch, which mustn't grow while it waits
+                if (size < 0)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (size) write((Queued) _record[0], {_record + 1, (std::size_t) size - 1});
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(Log::WriteMutex);
+                if (u64 dropped = _dropped.load(std::memory_order_relaxed); dropped != reported)
+                {
+                    std::string_view line(_record, fmt::format_to_n(_record, _queue.maxRecordSize(),
+                        "{}{}[{} - {}]: {} log messages were dropped\n{}", Log::Styles::Default, Log::Colours::Yellow,
+                        Log::Timestamp(), Log::Level::Warning, dropped - reported, Log::Styles::Default).out);
+                    std::cout << line;
+                    if (Log::FileStream.is_open()) Log::FileStream << line;
+                    reported = dropped;
+                }
+                std::cout.flush();
+                if (Log::FileStream.is_open()) Log::FileStream.flush();
+                if (TraceStream.is_open()) TraceStream.flush();
+            }
+            _flushed.store(_queue.head(), std::memory_order_release);
+            _flushed.notify_all();
+
+            if (_stopping.load() && _queue.empty()) break;
+        }
+    }
+
+    void write(Queued kind, std::span<const char> payload)
+    {
+        std::unique_lock<std::mutex> lock(Log::WriteMutex);
+        if (kind == Queued::Text)
+        {
+            std::cout.write(payload.data(), (std::streamsize) payload.size());
+            if (Log::FileStream.is_open()) Log::FileStream.write(payload.data(), (std::streamsize) payload.size());
+            return;
+        }
+
+        if (payload[0] == (char) LogTrace::Record::Format) TraceFormats.emplace_back(payload.data(), payload.size());
+        if (TraceStream.is_open()) TraceStream.write(payload.data(), (std::streamsize) payload.size());
+    }
+
+    MpscQueue _queue{QueueCells, MemoryTag::Logging};
+    // Where each record is copied out of the queue before being written
+    char *_record;
+    std::atomic<u64> _dropped{0};
+    // The queue position up to which everything is written and flushed
+    std::atomic<u64> _flushed{0};
+    std::atomic<bool> _stopping{false};
+    std::thread _thread;
+};
+
+#ifdef DDLS_DEBUG
+/**
+ * @brief Reports heap leaks at exit, defined after the log streams so that they outlive it
+ * 
+ */
+static struct HeapLeakReporter
+{
+    ~HeapLeakReporter()
+    {
+        // The writer may already be gone, or never have started
+        WriterStopped.store(true);
+        Memory::ReportLeaks();
+    }
+} heapLeakReporter;
+#endif
 
 void Log::OpenLog(const std::filesystem::path &filepath)
 {
+    // Earlier messages don't belong to the file
+    Flush();
+
     if (auto parentPath = filepath.parent_path(); !parentPath.empty())
         std::filesystem::create_directories(parentPath);
+    std::unique_lock<std::mutex> lock(WriteMutex);
     FileStream.open(filepath);
 }
 
 void Log::CloseLog()
 {
+    Flush();
+
+    std::unique_lock<std::mutex> lock(WriteMutex);
     FileStream.close();
 }
 
-} // namespace ddls
\ No newline at end of file
+void Log::Flush()
+{
+    if (WriterStopped.load()) return;
+
+    LogWriter::Instance().flush();
+}
+
+void Log::SetLevel(LogCategory category, LogLevel level)
+{
+    Levels[(u8) category].store(level, std::memory_order_relaxed);
+}
+
+LogLevel Log::GetLevel(LogCategory category)
+{
+    return Levels[(u8) category].load(std::memory_order_relaxed);
+}
+
+std::string_view Log::CategoryName(LogCategory category)
+{
+    switch (category)
+    {
+        case LogCategory::General:   return "General";
+        case LogCategory::Renderer:  return "Renderer";
+        case LogCategory::Resources: return "Resources";
+        case LogCategory::Vulkan:    return "Vulkan";
+        case LogCategory::Scripting: return "Scripting";
+        default:                     return "Unknown";
+    }
+}
+
+i64 LogSite::Now()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Boolean LogSite::allow(u32 perSecond, u64 &suppressed)
+{
+    i64 now = Now();
+    i64 second = _second.load(std::memory_order_relaxed);
+    // The first message of a second starts counting again
+    if (second != now && _second.compare_exchange_strong(second, now, std::memory_order_relaxed))
+        _count.store(0, std::memory_order_relaxed);
+
+    if (_count.fetch_add(1, std::memory_order_relaxed) >= perSecond)
+    {
+        _suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+Boolean LogSite::differs(u64 hash, u64 &repeats)
+{
+    i64 now = Now();
+    Boolean first = !_fired.exchange(true, std::memory_order_relaxed);
+    if (_hash.exchange(hash, std::memory_order_relaxed) != hash || first)
+    {
+        _second.store(now, std::memory_order_relaxed);
+        repeats = _repeats.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    _repeats.fetch_add(1, std::memory_order_relaxed);
+    i64 second = _second.load(std::memory_order_relaxed);
+    // Summarised by the first repeat of every second after the message was written
+    repeats = second != now && _second.compare_exchange_strong(second, now, std::memory_order_relaxed)
+        ? _repeats.exchange(0, std::memory_order_relaxed) : 0;
+    return false;
+}
+
+void Log::SetOverflow(Overflow overflow)
+{
+    OverflowPolicy.store(overflow, std::memory_order_relaxed);
+}
+
+std::string_view Log::Timestamp()
+{
+    // Per thread so that no lock is needed, only reformatted when the second changes
+    thread_local struct
+    {
+        i64 second = -1;
+        char text[64];
+        u64 length = 0;
+    } cache;
+
+    i64 now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    i64 second = now / 1000;
+    if (second != cache.second)
+    {
+        std::tm local = Time::LocalTime((std::time_t) second);
+        // Leaves room for the milliseconds
+        cache.length = std::strftime(cache.text, sizeof(cache.text) - 4, TimestampFormat, &local);
+        cache.second = second;
+    }
+
+    char *end = fmt::format_to(cache.text + cache.length, ".{:03}", now % 1000);
+
+    return {cache.text, (std::size_t) (end - cache.text)};
+}
+
+void Log::OpenTraceLog(const std::filesystem::path &filepath)
+{
+    // Every format queued so far is known to the writer
+    Flush();
+
+    if (auto parentPath = filepath.parent_path(); !parentPath.empty())
+        std::filesystem::create_directories(parentPath);
+    std::unique_lock<std::mutex> lock(WriteMutex);
+    TraceStream.open(filepath, std::ios::binary);
+    if (!TraceStream.is_open()) return;
+
+    char header[LogTrace::HeaderSize];
+    LogTrace::WriteHeader(header);
+    TraceStream.write(header, LogTrace::HeaderSize);
+    for (const std::string &format : TraceFormats) TraceStream.write(format.data(), (std::streamsize) format.size());
+    Tracing.store(true);
+}
+
+void Log::CloseTraceLog()
+{
+    Tracing.store(false);
+    Flush();
+
+    std::unique_lock<std::mutex> lock(WriteMutex);
+    TraceStream.close();
+}
+
+void Log::RegisterTraceFormat(StringId id, std::string_view format)
+{
+    std::vector<char> record(LogTrace::FormatSize(format));
+    LogTrace::EncodeFormat(record.data(), id, format);
+
+    // Never dropped, the events using it couldn't be decoded
+    if (!WriterStopped.load()) LogWriter::Instance().push(Queued::Trace, record, Overflow::Block);
+}
+
+void Log::EnqueueTrace(std::span<const char> record)
+{
+    if (!WriterStopped.load()) LogWriter::Instance().push(Queued::Trace, record, OverflowPolicy.load(std::memory_order_relaxed));
+}
+
+void Log::Enqueue(std::string_view line)
+{
+    if (!WriterStopped.load())
+    {
+        LogWriter::Instance().push(Queued::Text, line, OverflowPolicy.load(std::memory_order_relaxed));
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(WriteMutex);
+    std::cout << line;
+    if (FileStream.is_open()) FileStream << line;
+}
+
+} // namespace ddls
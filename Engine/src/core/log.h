@@ -3,10 +3,17 @@
 #include "core/time.h"
 #include "core/types.h"
 #include "core/assert.h"
+#include "core/log_trace.h"
+#include "core/string_id.h"
 
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <span>
 #include <string_view>
+#include <type_traits>
 #include <filesystem>
 #include <cassert>
 #include <sstream>
@@ -14,11 +21,100 @@
 #include <iostream>
 #include <fstream>
 
+// Messages below this level are compiled out, from 0 for LogLevel::Debug to 4 for LogLevel::Off
+#ifndef DDLS_LOG_LEVEL
+#ifdef DDLS_DEBUG
+#define DDLS_LOG_LEVEL 0
+#else
+#define DDLS_LOG_LEVEL 1
+#endif
+#endif
+
 namespace ddls {
 
+/**
+ * @brief How important a message is, from the least to the most
+ * 
+ */
+enum class LogLevel : u8
+{
+    Debug,
+    Info,
+    Warning,
+    Error,
+    // Above every message, to silence a category
+    Off
+};
+
+/**
+ * @brief The subsystem a message comes from, each one has its own runtime level
+ * 
+ */
+enum class LogCategory : u8
+{
+    General,
+    Renderer,
+    Resources,
+    Vulkan,
+    Scripting,
+    Count
+};
+
+/**
+ * @brief The state of a rate-limited, one-shot or deduplicated log statement
+ * 
+ * Each statement keeps its own in a static, see DDLS_LOG_EVERY, DDLS_LOG_ONCE and DDLS_LOG_DEDUP.
+ * Counts are approximate when several threads log from the same statement at once.
+ * 
+ */
+class DDLS_API LogSite
+{
+public:
+    /**
+     * @brief Counts a message against the limit of the current second
+     * 
+     * @param suppressed Set to the number of messages dropped since the last one allowed
+     * @return Whether the message is written
+     */
+    Boolean allow(u32 perSecond, u64 &suppressed);
+
+    /**
+     * @brief Whether this is the first message of the statement
+     * 
+     */
+    Boolean first() { return !_fired.exchange(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief Compares a message with the previous one of the statement
+     * 
+     * Repeats are summarised when the message changes, and once a second while it doesn't.
+     * 
+     * @param hash The hash of the formatted message
+     * @param repeats Set to the number of repeats of the previous message to summarise now, if any
+     * @return Whether the message differs from the previous one, and so is written
+     */
+    Boolean differs(u64 hash, u64 &repeats);
+
+private:
+    static i64 Now();
+
+    std::atomic<i64> _second{-1};
+    std::atomic<u32> _count{0};
+    std::atomic<u64> _suppressed{0};
+    std::atomic<u64> _hash{0};
+    std::atomic<u64> _repeats{0};
+    std::atomic<bool> _fired{false};
+};
+
 /**
  * @brief A logger that can write to std out and a file
  * 
+ * Messages are formatted on the calling thread, then queued for a writer thread
+ * which does the I/O, so that logging never waits on the console.
+ * 
+ * Messages below DDLS_LOG_LEVEL are compiled out. The others are skipped by a single branch
+ * when below the runtime level of their category, before anything is formatted.
+ * 
  */
 class DDLS_API Log
 {
@@ -68,10 +164,24 @@ public:
     };
 
     /**
-     * @brief Using 12-hour clock time
-     * @url https://en.cppreference.com/w/cpp/io/manip/put_time
+     * @brief What happens to a message logged while the queue is full
+     * 
+     */
+    enum class Overflow : u8
+    {
+        // Lost, the number of lost messages is reported once there is room again
+        Drop,
+        // The logging thread waits for the writer to make room
+        Block
+    };
+
+    static constexpr LogLevel CompiledLevel = (LogLevel) DDLS_LOG_LEVEL;
+
+    /**
+     * @brief Using 24-hour clock time, the milliseconds are appended to it
+     * @url https://en.cppreference.com/w/cpp/chrono/c/strftime
      */
-    static constexpr auto TimestampFormat = "%D - %r";
+    static constexpr auto TimestampFormat = "%m/%d/%Y - %T";
 
     /**
      * Outputs a message into the console.
@@ -82,25 +192,20 @@ public:
      */
     template<typename ... Args>
     static void
-    Out(const std::string_view &style, const std::string_view &colour, const std::string_view &level, Args ... args)
+    Out(const std::string_view &style, const std::string_view &colour, const std::string_view &level, Args &&... args)
     {
-        Write(style, colour, fmt::format("[{} - {}]: ", Time::GetDateTime(TimestampFormat), level), args..., '\n',
-              Styles::Default);
+        Print(style, colour, level, LogCategory::General, std::forward<Args>(args)...);
     }
 
     /**
-     * Outputs a debug message into the console.
+     * Outputs a debug message into the console, Log::Debug(LogCategory::Renderer, ...) for another category than General.
      * @tparam Args The value types to write.
      * @param args The values to write.
      */
     template<typename ... Args>
-    static void Debug(Args ... args)
+    static void Debug(Args &&... args)
     {
-#ifdef DDLS_DEBUG
-        Out(Styles::Default, Colours::LightBlue, Level::Debug, args...);
-#else
-        ignore(args...);
-#endif
+        Emit<LogLevel::Debug>(std::forward<Args>(args)...);
     }
 
     /**
@@ -109,9 +214,9 @@ public:
      * @param args The values to write.
      */
     template<typename ... Args>
-    static void Info(Args ... args)
+    static void Info(Args &&... args)
     {
-        Out(Styles::Default, Colours::Green, Level::Info, args...);
+        Emit<LogLevel::Info>(std::forward<Args>(args)...);
     }
 
     /**
@@ -120,9 +225,9 @@ public:
      * @param args The values to write.
      */
     template<typename ... Args>
-    static void Warning(Args ... args)
+    static void Warning(Args &&... args)
     {
-        Out(Styles::Default, Colours::Yellow, Level::Warning, args...);
+        Emit<LogLevel::Warning>(std::forward<Args>(args)...);
     }
 
     /**
@@ -131,18 +236,246 @@ public:
      * @param args The values to write.
      */
     template<typename ... Args>
-    static void Error(Args ... args)
+    static void Error(Args &&... args)
+    {
+        Emit<LogLevel::Error>(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Outputs at most perSecond messages a second from this site, and how many were dropped in between.
+     * Used through DDLS_LOG_EVERY, which keeps the site of each statement.
+     * @tparam Severity The level of the messages.
+     * @param args The values to write, optionally after a category.
+     */
+    template<LogLevel Severity, typename ... Args>
+    static void Limited(LogSite &site, u32 perSecond, Args &&... args)
+    {
+        if constexpr (Severity < CompiledLevel)
+        {
+            ignore(site, perSecond, args...);
+        }
+        else
+        {
+            WithCategory([&site, perSecond](LogCategory category, auto &&... rest) {
+                u64 suppressed;
+                if (!Enabled(Severity, category) || !site.allow(perSecond, suppressed)) return;
+                if (suppressed)
+                    PrintAt<Severity>(category, std::forward<decltype(rest)>(rest)..., " (", suppressed,
+                                      " similar messages suppressed)");
+                else
+                    PrintAt<Severity>(category, std::forward<decltype(rest)>(rest)...);
+            }, std::forward<Args>(args)...);
+        }
+    }
+
+    /**
+     * Outputs the first message from this site only.
+     * Used through DDLS_LOG_ONCE, which keeps the site of each statement.
+     * @tparam Severity The level of the message.
+     * @param args The values to write, optionally after a category.
+     */
+    template<LogLevel Severity, typename ... Args>
+    static void Once(LogSite &site, Args &&... args)
+    {
+        if constexpr (Severity < CompiledLevel)
+        {
+            ignore(site, args...);
+        }
+        else
+        {
+            WithCategory([&site](LogCategory category, auto &&... rest) {
+                if (Enabled(Severity, category) && site.first())
+                    PrintAt<Severity>(category, std::forward<decltype(rest)>(rest)...);
+            }, std::forward<Args>(args)...);
+        }
+    }
+
+    /**
+     * Outputs a message from this site unless it is the same as the previous one,
+     * repeats are collapsed into a "Last message repeated N times" line.
+     * The message is formatted to be compared, unlike with Limited().
+     * Used through DDLS_LOG_DEDUP, which keeps the site of each statement.
+     * @tparam Severity The level of the message.
+     * @param args The values to write, optionally after a category.
+     */
+    template<LogLevel Severity, typename ... Args>
+    static void Deduplicated(LogSite &site, Args &&... args)
+    {
+        if constexpr (Severity < CompiledLevel)
+        {
+            ignore(site, args...);
+        }
+        else
+        {
+            WithCategory([&site](LogCategory category, auto &&... rest) {
+                if (!Enabled(Severity, category)) return;
+
+                thread_local std::ostringstream text;
+                text.str({});
+                text.clear();
+                ((text << std::forward<decltype(rest)>(rest)), ...);
+                std::string_view message = text.view();
+
+                u64 repeats;
+                Boolean differs = site.differs(StringId::hash(message), repeats);
+                if (repeats) PrintAt<Severity>(category, "Last message repeated ", repeats, " times");
+                if (differs) PrintAt<Severity>(category, message);
+            }, std::forward<Args>(args)...);
+        }
+    }
+
+    /**
+     * @brief Whether messages of this level and category are written
+     * 
+     */
+    static bool Enabled(LogLevel level, LogCategory category = LogCategory::General)
     {
-        Out(Styles::Bold, Colours::Red, Level::Error, args...);
+        return level >= CompiledLevel && level >= Levels[(u8) category].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets the least important level written for a category, from any thread
+     * 
+     * Levels below DDLS_LOG_LEVEL stay compiled out whatever the runtime level.
+     * 
+     */
+    static void SetLevel(LogCategory category, LogLevel level);
+
+    static LogLevel GetLevel(LogCategory category);
+
+    static std::string_view CategoryName(LogCategory category);
+
+    /**
+     * Records an event into the trace log without formatting it, Log::Trace<"Frame {} took {} us">(frame, time).
+     * Only the id of the format and the raw arguments are queued, LogTrace::Decode() renders them later.
+     * While no trace log is open, it costs the registration of the format on first use and a branch.
+     * @tparam Format The fmt format string of the event.
+     * @tparam Args The value types to record, numbers, characters or strings.
+     * @param args The values to record.
+     */
+    template<TraceFormat Format, typename ... Args>
+    static void Trace(const Args &... args)
+    {
+        static constexpr StringId Id(Format.view());
+        // Once per format, the writer keeps it for every trace log opened later
+        static const bool registered = (RegisterTraceFormat(Id, Format.view()), true);
+        ignore(registered);
+        if (!Tracing.load(std::memory_order_relaxed)) return;
+
+        i64 now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        char event[LogTrace::MaxEventSize];
+        EnqueueTrace({event, (std::size_t) LogTrace::EncodeEvent(event, Id, now, args...)});
     }
 
     static void OpenLog(const std::filesystem::path &filepath);
 
     static void CloseLog();
 
+    /**
+     * @brief Starts writing the events recorded by Trace() into a binary file
+     * 
+     */
+    static void OpenTraceLog(const std::filesystem::path &filepath);
+
+    static void CloseTraceLog();
+
+    /**
+     * @brief Waits until every message logged so far is written out, such as before crashing
+     * 
+     */
+    static void Flush();
+
+    /**
+     * @brief Sets what happens to messages logged while the queue is full, Block by default
+     * 
+     */
+    static void SetOverflow(Overflow overflow);
+
 private:
     static std::mutex WriteMutex;
     static std::ofstream FileStream;
+    static std::atomic<bool> Tracing;
+    static std::atomic<LogLevel> Levels[(u8) LogCategory::Count];
+
+    /**
+     * @brief Checks the level, at compile time and then against the category, before formatting anything
+     * 
+     * The category is optional, as the first argument.
+     * 
+     */
+    template<LogLevel Severity, typename ... Args>
+    static void Emit(Args &&... args)
+    {
+        if constexpr (Severity < CompiledLevel)
+        {
+            ignore(args...);
+        }
+        else
+        {
+            WithCategory([](LogCategory category, auto &&... rest) {
+                if (Enabled(Severity, category)) PrintAt<Severity>(category, std::forward<decltype(rest)>(rest)...);
+            }, std::forward<Args>(args)...);
+        }
+    }
+
+    /**
+     * @brief Calls log with the category of a message and the values to write, General if it doesn't start with one
+     * 
+     */
+    template<typename Function, typename First, typename ... Args>
+    static void WithCategory(Function &&log, First &&first, Args &&... args)
+    {
+        if constexpr (std::is_same_v<std::remove_cvref_t<First>, LogCategory>)
+            log(first, std::forward<Args>(args)...);
+        else
+            log(LogCategory::General, std::forward<First>(first), std::forward<Args>(args)...);
+    }
+
+    template<LogLevel Severity, typename ... Args>
+    static void PrintAt(LogCategory category, Args &&... args)
+    {
+        Print(StyleOf(Severity), ColourOf(Severity), LevelOf(Severity), category, std::forward<Args>(args)...);
+    }
+
+    template<typename ... Args>
+    static void Print(std::string_view style, std::string_view colour, std::string_view level, LogCategory category,
+                      Args &&... args)
+    {
+        char prefix[128];
+        auto formatted = category == LogCategory::General
+            ? fmt::format_to_n(prefix, sizeof(prefix), "[{} - {}]: ", Timestamp(), level)
+            : fmt::format_to_n(prefix, sizeof(prefix), "[{} - {} - {}]: ", Timestamp(), level, CategoryName(category));
+        Write(style, colour, std::string_view(prefix, std::min(formatted.size, sizeof(prefix))),
+              std::forward<Args>(args)..., '\n', Styles::Default);
+    }
+
+    static constexpr std::string_view StyleOf(LogLevel level)
+    {
+        return level == LogLevel::Error ? Styles::Bold : Styles::Default;
+    }
+
+    static constexpr std::string_view ColourOf(LogLevel level)
+    {
+        switch (level)
+        {
+            case LogLevel::Debug:   return Colours::LightBlue;
+            case LogLevel::Info:    return Colours::Green;
+            case LogLevel::Warning: return Colours::Yellow;
+            default:                return Colours::Red;
+        }
+    }
+
+    static constexpr std::string_view LevelOf(LogLevel level)
+    {
+        switch (level)
+        {
+            case LogLevel::Debug:   return Level::Debug;
+            case LogLevel::Info:    return Level::Info;
+            case LogLevel::Warning: return Level::Warning;
+            default:                return Level::Error;
+        }
+    }
 
     /**
      * A internal method used to write values to the out stream and to a file.
@@ -150,15 +483,57 @@ private:
      * @param args The values to write.
      */
     template<typename ... Args>
-    static void Write(Args ... args)
+    static void Write(Args &&... args)
     {
-        std::unique_lock<std::mutex> lock(WriteMutex);
+        // Reused by every message of the thread, so that it stops allocating once large enough
+        thread_local std::ostringstream line;
+        line.str(std::string());
 
-        ((std::cout << std::forward<Args>(args)), ...);
-        if (FileStream.is_open()) {
-            ((FileStream << std::forward<Args>(args)), ...);
-        }
+        ((line << std::forward<Args>(args)), ...);
+        Enqueue(line.view());
     }
+
+    /**
+     * @brief The current local time, formatted with TimestampFormat and milliseconds
+     * 
+     * @return A view valid until the next call from the same thread
+     */
+    static std::string_view Timestamp();
+
+    /**
+     * @brief Queues a formatted message for the writer thread, or writes it at once past its shutdown
+     * 
+     */
+    static void Enqueue(std::string_view line);
+
+    static void RegisterTraceFormat(StringId id, std::string_view format);
+
+    static void EnqueueTrace(std::span<const char> record);
+
+    friend class LogWriter;
 };
 
-} // namespace ddls
\ No newline at end of file
+} // namespace ddls
+
+/**
+ * @brief Logs at most perSecond messages a second from this statement, DDLS_LOG_EVERY(Error, 1, "Failed to ", ...)
+ * 
+ */
+#define DDLS_LOG_EVERY(level, perSecond, ...) \
+    do { static ::ddls::LogSite _logSite; \
+        ::ddls::Log::Limited<::ddls::LogLevel::level>(_logSite, perSecond, __VA_ARGS__); } while (0)
+
+/**
+ * @brief Logs the first message of this statement only, DDLS_LOG_ONCE(Warning, "Falling back to ", ...)
+ * 
+ */
+#define DDLS_LOG_ONCE(level, ...) \
+    do { static ::ddls::LogSite _logSite; ::ddls::Log::Once<::ddls::LogLevel::level>(_logSite, __VA_ARGS__); } while (0)
+
+/**
+ * @brief Logs a message of this statement unless it repeats the previous one, DDLS_LOG_DEDUP(Error, "Validation: ", ...)
+ * 
+ */
+#define DDLS_LOG_DEDUP(level, ...) \
+    do { static ::ddls::LogSite _logSite; \
+        ::ddls::Log::Deduplicated<::ddls::LogLevel::level>(_logSite, __VA_ARGS__); } while (0)
@@ -0,0 +1,262 @@
+#include "core/log_trace.h"
+
+#include "core/hash_map.h"
+
+#include <fmt/args.h>
+#include <fmt/format.h>
+
+#include <string>
+#include <vector>
+
+namespace ddls {
+
+template<typename T>
+static Boolean read(std::span<const char> contents, u64 &offset, T &value)
+{
+    if (contents.size() - offset < sizeof(T)) return false;
+    std::memcpy(&value, contents.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+// The most digits of a width or precision in a format specification
+static constexpr u64 MaxSpecDigits = 4;
+
+static Boolean isNumeric(LogTrace::Argument type)
+{
+    return type == LogTrace::Argument::Signed || type == LogTrace::Argument::Unsigned ||
+           type == LogTrace::Argument::Float;
+}
+
+/**
+ * @brief Whether a format specification, past the colon, applies to an argument
+ *
+ * Stricter than fmt, so that anything accepted here formats without an error.
+ *
+ */
+static Boolean acceptsSpec(std::string_view spec, LogTrace::Argument type)
+{
+    using Argument = LogTrace::Argument;
+    auto isAlign = [](char c) { return c == '<' || c == '>' || c == '^' || c == '='; };
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+
+    u64 at = 0;
+    char align = 0;
+    if (spec.size() >= 2 && isAlign(spec[1]) && (u8) spec[0] < 0x80 && spec[0] != '{' && spec[0] != '}')
+    {
+        align = spec[1];
+        at = 2;
+    }
+    else if (!spec.empty() && isAlign(spec[0]))
+    {
+        align = spec[0];
+        at = 1;
+    }
+    if (align == '=' && !isNumeric(type)) return false;
+
+    if (at < spec.size() && (spec[at] == '+' || spec[at] == '-' || spec[at] == ' '))
+    {
+        if (type != Argument::Signed && type != Argument::Float) return false;
+        at++;
+    }
+    if (at < spec.size() && spec[at] == '#')
+    {
+        if (!isNumeric(type)) return false;
+        at++;
+    }
+    if (at < spec.size() && spec[at] == '0')
+    {
+        if (!isNumeric(type)) return false;
+        at++;
+    }
+    // Widths and precisions are kept small, fmt throws on huge ones and would allocate for them otherwise
+    auto skipNumber = [&spec, &at, &isDigit]() {
+        u64 start = at;
+        while (at < spec.size() && isDigit(spec[at])) at++;
+        return at - start <= MaxSpecDigits;
+    };
+    if (!skipNumber()) return false;
+    if (at < spec.size() && spec[at] == '.')
+    {
+        if (type != Argument::Float && type != Argument::String) return false;
+        if (++at == spec.size() || !isDigit(spec[at]) || !skipNumber()) return false;
+    }
+    if (at < spec.size() && spec[at] == 'L')
+    {
+        if (!isNumeric(type)) return false;
+        at++;
+    }
+    if (at == spec.size()) return true;
+    if (at + 1 != spec.size()) return false;
+
+    std::string_view types;
+    switch (type)
+    {
+        case Argument::Signed:
+        case Argument::Unsigned: types = "dxXbBo"; break;
+        case Argument::Float: types = "eEfFgGaA"; break;
+        case Argument::Bool: types = "s"; break;
+        case Argument::Char: types = "c"; break;
+        case Argument::String: types = "s"; break;
+    }
+    return types.find(spec[at]) != std::string_view::npos;
+}
+
+/**
+ * @brief Whether the arguments of an event fit its format, without throwing like fmt would on a mismatch
+ *
+ */
+static Boolean matches(std::string_view format, std::span<const LogTrace::Argument> types)
+{
+    u64 next = 0;
+    Boolean automatic = false, manual = false;
+    for (u64 at = 0; at < format.size(); at++)
+    {
+        if (format[at] == '}')
+        {
+            if (at + 1 == format.size() || format[at + 1] != '}') return false;
+            at++;
+            continue;
+        }
+        if (format[at] != '{') continue;
+        if (at + 1 < format.size() && format[at + 1] == '{')
+        {
+            at++;
+            continue;
+        }
+
+        u64 end = format.find('}', at);
+        if (end == std::string_view::npos) return false;
+        std::string_view field = format.substr(at + 1, end - at - 1);
+        // Nested replacement fields, for dynamic widths, aren't supported
+        if (field.find('{') != std::string_view::npos) return false;
+        at = end;
+
+        u64 colon = std::min(field.find(':'), field.size());
+        std::string_view id = field.substr(0, colon);
+        u64 index = 0;
+        if (id.empty())
+        {
+            automatic = true;
+            index = next++;
+        }
+        else
+        {
+            manual = true;
+            for (char c : id)
+            {
+                if (c < '0' || c > '9' || index > types.size()) return false;
+                index = index * 10 + (u64) (c - '0');
+            }
+        }
+        if (automatic && manual) return false;
+        if (index >= types.size()) return false;
+        if (colon < field.size() && !acceptsSpec(field.substr(colon + 1), types[index])) return false;
+    }
+
+    return true;
+}
+
+void LogTrace::WriteHeader(char *out)
+{
+    std::memcpy(out, &Magic, sizeof(u32));
+    std::memcpy(out + sizeof(u32), &Version, sizeof(u32));
+}
+
+u64 LogTrace::EncodeFormat(char *out, StringId id, std::string_view format)
+{
+    out[0] = (char) Record::Format;
+    u64 value = id.value();
+    u32 length = (u32) format.size();
+    std::memcpy(out + 1, &value, sizeof(u64));
+    std::memcpy(out + 1 + sizeof(u64), &length, sizeof(u32));
+    if (length) std::memcpy(out + 1 + sizeof(u64) + sizeof(u32), format.data(), length);
+
+    return FormatSize(format);
+}
+
+Boolean LogTrace::Decode(std::span<const char> contents, const std::function<void(i64, std::string_view)> &line)
+{
+    u64 offset = 0;
+    u32 magic, version;
+    if (!read(contents, offset, magic) || !read(contents, offset, version)) return false;
+    if (magic != Magic || version != Version) return false;
+
+    HashMap<u64, std::string> formats;
+    fmt::dynamic_format_arg_store<fmt::format_context> arguments;
+    std::vector<Argument> types;
+    std::string text;
+    while (offset < contents.size())
+    {
+        u8 kind;
+        u64 id;
+        read(contents, offset, kind);
+        if (!read(contents, offset, id)) return false;
+
+        if (kind == (u8) Record::Format)
+        {
+            u32 length;
+            if (!read(contents, offset, length) || contents.size() - offset < length) return false;
+            formats[id] = std::string(contents.data() + offset, length);
+            offset += length;
+            continue;
+        }
+        if (kind != (u8) Record::Event) return false;
+
+        i64 timestamp;
+        u16 argumentsSize;
+        if (!read(contents, offset, timestamp) || !read(contents, offset, argumentsSize)) return false;
+        if (contents.size() - offset < argumentsSize) return false;
+
+        std::span<const char> encoded = contents.subspan(offset, argumentsSize);
+        offset += argumentsSize;
+
+        arguments.clear();
+        types.clear();
+        for (u64 at = 0; at < encoded.size();)
+        {
+            Argument type = (Argument) encoded[at++];
+            types.push_back(type);
+            switch (type)
+            {
+                case Argument::Signed: { i64 value = 0; read(encoded, at, value); arguments.push_back(value); break; }
+                case Argument::Unsigned: { u64 value = 0; read(encoded, at, value); arguments.push_back(value); break; }
+                case Argument::Float: { f64 value = 0; read(encoded, at, value); arguments.push_back(value); break; }
+                case Argument::Bool: { u8 value = 0; read(encoded, at, value); arguments.push_back((bool) value); break; }
+                case Argument::Char: { char value = 0; read(encoded, at, value); arguments.push_back(value); break; }
+                case Argument::String:
+                {
+                    u16 length = 0;
+                    read(encoded, at, length);
+                    length = (u16) std::min<u64>(length, encoded.size() - at);
+                    // Copied, the store outlives the view
+                    arguments.push_back(std::string(encoded.data() + at, length));
+                    at += length;
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        const std::string *format = formats.find(id);
+        if (!format)
+        {
+            text = fmt::format("<unknown format {:016x}>", id);
+        }
+        else if (!matches(*format, types))
+        {
+            // Formats are only checked here, a mismatch shows up in the rendered text
+            text = fmt::format("<mismatched arguments: \"{}\">", *format);
+        }
+        else
+        {
+            text = fmt::vformat(*format, arguments);
+        }
+        line(timestamp, text);
+    }
+
+    return true;
+}
+
+} // namespace ddls
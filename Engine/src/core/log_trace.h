@@ -0,0 +1,176 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+#include "core/error.h"
+#include "core/string_id.h"
+#include "utils/helper.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace ddls {
+
+/**
+ * @brief A format string passed as a template argument, so that it is hashed at compile time
+ *
+ */
+template<std::size_t Length>
+struct TraceFormat
+{
+    char text[Length];
+
+    consteval TraceFormat(const char (&string)[Length]) { std::copy(string, string + Length, text); }
+
+    constexpr std::string_view view() const { return {text, Length - 1}; }
+};
+
+/**
+ * @brief The layout of binary trace logs, written by Log::Trace() and rendered back to text by Decode()
+ *
+ * A trace log is a LogTrace header followed by records, each starting with its kind:
+ * - Format, a u64 format id, the u32 length of the format string, then the string. It is written
+ *   before the first event using the format.
+ * - Event, a u64 format id, an i64 timestamp in microseconds since the epoch, the u16 size of the
+ *   arguments, then each argument as its type followed by its value.
+ *
+ * Trace logs are little-endian, like archives.
+ *
+ */
+class DDLS_API LogTrace : public Helper
+{
+public:
+    static constexpr u32 Magic = 0x474F4C44; // "DLOG"
+    static constexpr u32 Version = 1;
+    static constexpr const char *Extension = ".dlog";
+
+    static constexpr u64 HeaderSize = 2 * sizeof(u32);
+    static constexpr u64 EventHeaderSize = 1 + sizeof(u64) + sizeof(i64) + sizeof(u16);
+    // Longer string arguments are truncated to fit
+    static constexpr u64 MaxEventSize = 512;
+
+    enum class Record : u8
+    {
+        Format,
+        Event
+    };
+
+    enum class Argument : u8
+    {
+        Signed,
+        Unsigned,
+        Float,
+        Bool,
+        Char,
+        // A u16 length and the characters
+        String
+    };
+
+    /**
+     * @brief Writes the header of a trace log
+     *
+     * @param out Room for HeaderSize bytes
+     */
+    static void WriteHeader(char *out);
+
+    /**
+     * @brief Encodes a format record
+     *
+     * @param out Room for FormatSize(format) bytes
+     */
+    static u64 EncodeFormat(char *out, StringId id, std::string_view format);
+
+    static u64 FormatSize(std::string_view format) { return 1 + sizeof(u64) + sizeof(u32) + format.size(); }
+
+    /**
+     * @brief Encodes an event record, copying the raw arguments without formatting them
+     *
+     * @param out Room for MaxEventSize bytes
+     * @return The size of the record
+     */
+    template<typename ... Args>
+    static u64 EncodeEvent(char *out, StringId id, i64 timestamp, const Args &... args)
+    {
+        u64 size = EventHeaderSize;
+        ((size += EncodeArgument(out + size, MaxEventSize - size, args)), ...);
+
+        u16 argumentsSize = (u16) (size - EventHeaderSize);
+        out[0] = (char) Record::Event;
+        u64 value = id.value();
+        std::memcpy(out + 1, &value, sizeof(u64));
+        std::memcpy(out + 1 + sizeof(u64), &timestamp, sizeof(i64));
+        std::memcpy(out + 1 + sizeof(u64) + sizeof(i64), &argumentsSize, sizeof(u16));
+
+        return size;
+    }
+
+    /**
+     * @brief Renders every event of a trace log, in order
+     *
+     * Events whose format is missing or doesn't match their arguments are rendered
+     * with what is known of them.
+     *
+     * @param line Called with the timestamp of every event, in microseconds since the epoch, and its text
+     * @return false if contents isn't a valid trace log, the events up to the damage are still rendered
+     */
+    static Boolean Decode(std::span<const char> contents, const std::function<void(i64, std::string_view)> &line);
+
+private:
+    template<typename T>
+    static u64 EncodeArgument(char *out, u64 room, const T &value)
+    {
+        if constexpr (std::is_enum_v<T>)
+        {
+            return EncodeArgument(out, room, (std::underlying_type_t<T>) value);
+        }
+        else if constexpr (std::is_same_v<T, bool>)
+        {
+            return EncodeScalar(out, room, Argument::Bool, (u8) value);
+        }
+        else if constexpr (std::is_same_v<T, char>)
+        {
+            return EncodeScalar(out, room, Argument::Char, value);
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            return EncodeScalar(out, room, Argument::Float, (f64) value);
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            return EncodeScalar(out, room, Argument::Signed, (i64) value);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            return EncodeScalar(out, room, Argument::Unsigned, (u64) value);
+        }
+        else
+        {
+            static_assert(std::is_convertible_v<const T &, std::string_view>,
+                "Trace arguments are numbers, characters or strings");
+
+            std::string_view string = value;
+            if (room < 1 + sizeof(u16)) return 0;
+            u16 length = (u16) std::min<u64>(string.size(), room - 1 - sizeof(u16));
+            out[0] = (char) Argument::String;
+            std::memcpy(out + 1, &length, sizeof(u16));
+            if (length) std::memcpy(out + 1 + sizeof(u16), string.data(), length);
+            return 1 + sizeof(u16) + length;
+        }
+    }
+
+    template<typename T>
+    static u64 EncodeScalar(char *out, u64 room, Argument type, T value)
+    {
+        // Arguments past a full event are dropped
+        if (room < 1 + sizeof(T)) return 0;
+        out[0] = (char) type;
+        std::memcpy(out + 1, &value, sizeof(T));
+        return 1 + sizeof(T);
+    }
+};
+
+} // namespace ddls
@@ -0,0 +1,170 @@
+#include "core/lz4.h"
+
+#include <cstring>
+
+namespace ddls {
+
+static constexpr u64 MinMatch = 4;
+static constexpr u64 LastLiterals = 5;
+// The last match must start at least this far from the end of the block
+static constexpr u64 MatchFindLimit = 12;
+static constexpr u64 MaxOffset = 65535;
+static constexpr u32 HashBits = 12;
+
+static u32 read32(const u8 *source)
+{
+    u32 value;
+    std::memcpy(&value, source, sizeof(value));
+    return value;
+}
+
+static u32 hash(u32 sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HashBits);
+}
+
+static Boolean writeLength(u8 *&out, const u8 *outEnd, u64 length)
+{
+    for (; length >= 255; length -= 255)
+    {
+        if (out == outEnd) return false;
+        *out++ = 255;
+    }
+    if (out == outEnd) return false;
+    *out++ = (u8) length;
+    return true;
+}
+
+static Boolean writeSequence(u8 *&out, const u8 *outEnd, const u8 *literals, u64 literalCount,
+    u64 offset, u64 matchLength)
+{
+    if (out == outEnd) return false;
+    u8 *token = out++;
+    *token = (u8) ((literalCount < 15 ? literalCount : 15) << 4);
+    if (literalCount >= 15 && !writeLength(out, outEnd, literalCount - 15)) return false;
+
+    if ((u64) (outEnd - out) < literalCount) return false;
+    if (literalCount) std::memcpy(out, literals, literalCount);
+    out += literalCount;
+
+    // The last sequence only holds literals
+    if (!offset) return true;
+
+    if (outEnd - out < 2) return false;
+    *out++ = (u8) offset;
+    *out++ = (u8) (offset >> 8);
+    u64 length = matchLength - MinMatch;
+    *token |= (u8) (length < 15 ? length : 15);
+    return length < 15 || writeLength(out, outEnd, length - 15);
+}
+
+static Boolean readLength(const u8 *&in, const u8 *inEnd, u64 &length)
+{
+    u8 byte;
+    do
+    {
+        if (in == inEnd) return false;
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+u64 Lz4::Compress(const u8 *source, u64 size, u8 *destination, u64 capacity)
+{
+    const u8 *end = source + size;
+    const u8 *anchor = source;
+    u8 *out = destination;
+    const u8 *outEnd = destination + capacity;
+
+    if (size > MatchFindLimit)
+    {
+        u32 table[1 << HashBits] = {};
+        const u8 *matchLimit = end - MatchFindLimit;
+        const u8 *extendLimit = end - LastLiterals;
+        const u8 *in = source;
+        u32 misses = 0;
+
+        while (in < matchLimit)
+        {
+            u32 sequence = read32(in);
+            u32 slot = hash(sequence);
+            const u8 *candidate = source + table[slot];
+            table[slot] = (u32) (in - source);
+
+            if (candidate >= in || (u64) (in - candidate) > MaxOffset || read32(candidate) != sequence)
+            {
+                // Skip faster through data that doesn't compress
+                in += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            const u8 *matchEnd = in + MinMatch;
+            const u8 *reference = candidate + MinMatch;
+            while (matchEnd < extendLimit && *matchEnd == *reference)
+            {
+                matchEnd++;
+                reference++;
+            }
+
+            if (!writeSequence(out, outEnd, anchor, (u64) (in - anchor), (u64) (in - candidate),
+                (u64) (matchEnd - in))) return 0;
+            in = matchEnd;
+            anchor = in;
+        }
+    }
+
+    if (!writeSequence(out, outEnd, anchor, (u64) (end - anchor), 0, 0)) return 0;
+
+    return (u64) (out - destination);
+}
+
+Boolean Lz4::Decompress(const u8 *source, u64 sourceSize, u8 *destination, u64 size)
+{
+    const u8 *in = source;
+    const u8 *inEnd = source + sourceSize;
+    u8 *out = destination;
+    const u8 *outEnd = destination + size;
+
+    while (in < inEnd)
+    {
+        u8 token = *in++;
+
+        u64 literalCount = token >> 4;
+        if (literalCount == 15 && !readLength(in, inEnd, literalCount)) return false;
+        if (literalCount > (u64) (inEnd - in) || literalCount > (u64) (outEnd - out)) return false;
+        if (literalCount) std::memcpy(out, in, literalCount);
+        in += literalCount;
+        out += literalCount;
+
+        // The last sequence has no match
+        if (in == inEnd) break;
+
+        if (inEnd - in < 2) return false;
+        u64 offset = (u64) in[0] | ((u64) in[1] << 8);
+        in += 2;
+        if (!offset || offset > (u64) (out - destination)) return false;
+
+        u64 matchLength = token & 15;
+        if (matchLength == 15 && !readLength(in, inEnd, matchLength)) return false;
+        matchLength += MinMatch;
+        if (matchLength > (u64) (outEnd - out)) return false;
+
+        const u8 *reference = out - offset;
+        if (offset >= matchLength)
+        {
+            std::memcpy(out, reference, matchLength);
+            out += matchLength;
+        }
+        else
+        {
+            // Overlapping matches repeat the last offset bytes
+            for (u64 i = 0; i < matchLength; i++) *out++ = reference[i];
+        }
+    }
+
+    return out == outEnd;
+}
+
+} // namespace ddls
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+#include "core/error.h"
+#include "utils/helper.h"
+
+namespace ddls {
+
+/**
+ * @brief A self-contained codec for the LZ4 block format
+ * 
+ * Favours decoding speed over ratio: a greedy single-probe compressor, and a decoder
+ * that validates every length and offset so corrupt input fails instead of overrunning.
+ * 
+ */
+class DDLS_API Lz4 : public Helper
+{
+public:
+    /**
+     * @brief The largest compressed size of size bytes of input
+     * 
+     */
+    static constexpr u64 CompressBound(u64 size) { return size + size / 255 + 16; }
+
+    /**
+     * @brief Compresses a block
+     * 
+     * @return The compressed size, 0 if it doesn't fit in capacity
+     */
+    static u64 Compress(const u8 *source, u64 size, u8 *destination, u64 capacity);
+
+    /**
+     * @brief Decompresses a block whose decompressed size is known
+     * 
+     * @return false if the block is corrupt or doesn't decompress to exactly size bytes
+     */
+    static Boolean Decompress(const u8 *source, u64 sourceSize, u8 *destination, u64 size);
+};
+
+} // namespace ddls
@@ -0,0 +1,159 @@
+#include "core/mapped_file.h"
+
+#include <utility>
+
+#ifdef DDLS_PLATFORM_WINDOWS
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ddls {
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    std::swap(_open, other._open);
+#ifdef DDLS_PLATFORM_WINDOWS
+    std::swap(_mapping, other._mapping);
+#endif
+    return *this;
+}
+
+#ifdef DDLS_PLATFORM_WINDOWS
+
+Boolean MappedFile::open(const std::filesystem::path &path, FileAccess access)
+{
+    close();
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        access == FileAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN :
+        access == FileAccess::Random ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    _size = (u64) size.QuadPart;
+
+    // Empty files cannot be mapped, they are open with an empty view
+    if (_size)
+    {
+        _mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        _data = _mapping ? MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    }
+    // The mapping keeps the file alive
+    CloseHandle(file);
+
+    if (_size && !_data)
+    {
+        close();
+        return false;
+    }
+    _open = true;
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_data) UnmapViewOfFile(_data);
+    if (_mapping) CloseHandle(_mapping);
+    _data = nullptr;
+    _mapping = nullptr;
+    _size = 0;
+    _open = false;
+}
+
+void MappedFile::advise(FileAccess access) const
+{
+    // Only settable when opening the file
+    ignore(access);
+}
+
+#else
+
+Boolean MappedFile::open(const std::filesystem::path &path, FileAccess access)
+{
+    close();
+
+    int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) return false;
+
+    struct stat status;
+    if (fstat(file, &status) != 0)
+    {
+        ::close(file);
+        return false;
+    }
+    _size = (u64) status.st_size;
+
+    // Empty files cannot be mapped, they are open with an empty view
+    if (_size)
+    {
+        // Shared and read-only, so that the pages are the page cache's own
+        void *address = mmap(nullptr, _size, PROT_READ, MAP_SHARED, file, 0);
+        _data = address == MAP_FAILED ? nullptr : address;
+    }
+    // The mapping keeps the file alive
+    ::close(file);
+
+    if (_size && !_data)
+    {
+        _size = 0;
+        return false;
+    }
+    _open = true;
+    advise(access);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_data) munmap(_data, _size);
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+}
+
+void MappedFile::advise(FileAccess access) const
+{
+    if (!_data) return;
+
+    switch (access)
+    {
+        case FileAccess::Normal:
+            madvise(_data, _size, MADV_NORMAL);
+            break;
+        case FileAccess::Sequential:
+            // Start reading the whole file in before it's touched
+            madvise(_data, _size, MADV_SEQUENTIAL);
+            madvise(_data, _size, MADV_WILLNEED);
+            break;
+        case FileAccess::Random:
+            madvise(_data, _size, MADV_RANDOM);
+            break;
+    }
+}
+
+#endif
+
+} // namespace ddls
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+#include "core/error.h"
+
+#include <filesystem>
+#include <span>
+
+namespace ddls {
+
+/**
+ * @brief How a mapped file is going to be read, hinting the kernel's read-ahead
+ * 
+ */
+enum class FileAccess : u8
+{
+    Normal,
+    /** @brief Read once from start to end, read ahead aggressively */
+    Sequential,
+    /** @brief Read in scattered places, such as an archive's entries */
+    Random
+};
+
+/**
+ * @brief A read-only view of a whole file mapped into memory
+ * 
+ * Pages are loaded on first access and shared with every process mapping the same file
+ * through the page cache, nothing is copied. The contents are not null-terminated.
+ * 
+ */
+class DDLS_API MappedFile
+{
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Unmaps the file
+     * 
+     */
+    ~MappedFile();
+
+    MappedFile(MappedFile const&)      = delete;
+    void operator=(MappedFile const&)  = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    /**
+     * @brief Maps the file at the given path, replacing any previous mapping
+     * 
+     * @return false if the file cannot be opened or mapped
+     */
+    Boolean open(const std::filesystem::path &path, FileAccess access = FileAccess::Normal);
+
+    /**
+     * @brief Unmaps the file, the view is empty afterwards
+     * 
+     */
+    void close();
+
+    /**
+     * @brief Changes the access hint of the mapping, a no-op where unsupported
+     * 
+     */
+    void advise(FileAccess access) const;
+
+    Boolean isOpen() const { return _open; }
+
+    const char *data() const { return (const char *) _data; }
+
+    u64 size() const { return _size; }
+
+    std::span<const char> view() const { return {data(), (std::size_t) _size}; }
+
+private:
+    void *_data = nullptr;
+    u64 _size = 0;
+    Boolean _open = false;
+#ifdef DDLS_PLATFORM_WINDOWS
+    void *_mapping = nullptr;
+#endif
+};
+
+} // namespace ddls
@@ -0,0 +1,206 @@
+#include "core/memory.h"
+
+#include "core/log.h"
+#include "memory/allocation_tracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace ddls {
+
+static constexpr u32 TagCount = (u32) MemoryTag::Count;
+
+/**
+ * @brief Counters written by a single thread, read by any
+ * 
+ */
+struct ThreadMemoryCounters
+{
+    std::atomic<u64> allocatedBytes[TagCount]{};
+    std::atomic<u64> freedBytes[TagCount]{};
+    std::atomic<u64> allocations[TagCount]{};
+    std::atomic<u64> frees[TagCount]{};
+};
+
+struct MemoryCountersRegistry
+{
+    std::mutex mutex;
+    std::vector<ThreadMemoryCounters *> threads;
+};
+
+// Never destroyed so that allocators outliving static destruction can still be accounted
+static MemoryCountersRegistry &registry()
+{
+    static MemoryCountersRegistry *registry = new MemoryCountersRegistry();
+    return *registry;
+}
+
+// Blocks are kept when their thread exits, their counts still belong to the totals
+static ThreadMemoryCounters &threadCounters()
+{
+    thread_local ThreadMemoryCounters *counters = nullptr;
+    if (!counters)
+    {
+        counters = new ThreadMemoryCounters();
+        std::unique_lock<std::mutex> lock(registry().mutex);
+        registry().threads.push_back(counters);
+    }
+    return *counters;
+}
+
+// Only the owning thread writes, a relaxed load and store avoids a locked instruction
+static inline void bump(std::atomic<u64> &counter, u64 value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void Memory::TrackAllocation(MemoryTag tag, u64 size)
+{
+    ThreadMemoryCounters &counters = threadCounters();
+    bump(counters.allocatedBytes[(u32) tag], size);
+    bump(counters.allocations[(u32) tag], 1);
+}
+
+void Memory::TrackFree(MemoryTag tag, u64 size)
+{
+    ThreadMemoryCounters &counters = threadCounters();
+    bump(counters.freedBytes[(u32) tag], size);
+    bump(counters.frees[(u32) tag], 1);
+}
+
+MemoryTagStats Memory::Stats(MemoryTag tag)
+{
+    u32 index = (u32) tag;
+    u64 allocated = 0, freed = 0;
+    MemoryTagStats stats{};
+
+    std::unique_lock<std::mutex> lock(registry().mutex);
+    for (ThreadMemoryCounters *counters : registry().threads)
+    {
+        allocated += counters->allocatedBytes[index].load(std::memory_order_relaxed);
+        freed += counters->freedBytes[index].load(std::memory_order_relaxed);
+        stats.allocations += counters->allocations[index].load(std::memory_order_relaxed);
+        stats.frees += counters->frees[index].load(std::memory_order_relaxed);
+    }
+    stats.bytes = (i64) allocated - (i64) freed;
+    stats.totalBytes = allocated;
+
+    return stats;
+}
+
+const char *Memory::TagName(MemoryTag tag)
+{
+    switch (tag)
+    {
+        case MemoryTag::Logging:       return "Logging";
+        case MemoryTag::Miscellaneous: return "Miscellaneous";
+        case MemoryTag::Files:         return "Files";
+        case MemoryTag::Textures:      return "Textures";
+        case MemoryTag::Fonts:         return "Fonts";
+        case MemoryTag::Renderer:      return "Renderer";
+        case MemoryTag::Scratch:       return "Scratch";
+        case MemoryTag::Count:         break;
+    }
+    return "Unknown";
+}
+
+void Memory::Report()
+{
+    Log::Info("Memory usage per tag");
+    for (u32 i = 0; i < TagCount; i++)
+    {
+        MemoryTagStats stats = Stats((MemoryTag) i);
+        if (!stats.allocations) continue;
+        Log::Info('\t', TagName((MemoryTag) i), ": ", stats.bytes, " bytes in use, ",
+            stats.allocations - stats.frees, " live allocations (", stats.totalBytes, " bytes in ",
+            stats.allocations, " allocations total)");
+    }
+}
+
+/**
+ * @brief Prefix of every heap allocation, so that frees can be accounted
+ * 
+ */
+struct HeapHeader
+{
+    MemSize size;
+    MemoryTag tag;
+};
+
+// Layout of a heap block: [header][front guard][allocation][back guard]
+static constexpr MemSize HeapOffset =
+    alignForward(sizeof(HeapHeader), DefaultAlignment) + alignForward(GuardSize, DefaultAlignment);
+
+#ifdef DDLS_DEBUG
+struct HeapTracker
+{
+    std::mutex mutex;
+    AllocationTracker tracker{"Heap"};
+};
+
+// Never destroyed so that frees during static destruction are still checked
+static HeapTracker &heapTracker()
+{
+    static HeapTracker *tracker = new HeapTracker();
+    return *tracker;
+}
+#endif
+
+Ptr Memory::Allocate(MemSize size, MemoryTag tag, const std::source_location &site)
+{
+    u8 *block = (u8 *) std::malloc(HeapOffset + size + GuardSize);
+    if (!block) return nullptr;
+
+    new (block) HeapHeader{size, tag};
+    u8 *allocation = block + HeapOffset;
+#ifdef DDLS_DEBUG
+    {
+        std::unique_lock<std::mutex> lock(heapTracker().mutex);
+        if (!heapTracker().tracker.add(allocation, size, site))
+        {
+            std::free(block);
+            return nullptr;
+        }
+    }
+#else
+    ignore(site);
+#endif
+    TrackAllocation(tag, size);
+
+    return allocation;
+}
+
+void Memory::Free(Ptr pointer, const std::source_location &site)
+{
+    if (!pointer) return;
+
+#ifdef DDLS_DEBUG
+    {
+        std::unique_lock<std::mutex> lock(heapTracker().mutex);
+        if (!heapTracker().tracker.remove((u8 *) pointer, site)) return;
+    }
+#else
+    ignore(site);
+#endif
+
+    u8 *block = (u8 *) pointer - HeapOffset;
+    HeapHeader *header = (HeapHeader *) block;
+    TrackFree(header->tag, header->size);
+    std::free(block);
+}
+
+u64 Memory::ReportLeaks()
+{
+#ifdef DDLS_DEBUG
+    std::unique_lock<std::mutex> lock(heapTracker().mutex);
+    heapTracker().tracker.check();
+    return heapTracker().tracker.reportLeaks();
+#else
+    return 0;
+#endif
+}
+
+} // namespace ddls
@@ -1,6 +1,11 @@
 #pragma once
 
+#include "defines.h"
 #include "types.h"
+#include "utils/helper.h"
+
+#include <cstddef>
+#include <source_location>
 
 namespace ddls {
 
@@ -8,23 +13,141 @@ namespace ddls {
  * @brief Type for a memory size in bytes
  * 
  */
-using MemSize = u32;
-static MemSize MemSize_default = 1024;
+using MemSize = u64;
+static constexpr MemSize MemSize_default = 1024;
 
 /**
  * @brief Type for pointers
  * 
  */
-using Ptr = u32 *;
+using Ptr = void *;
+
+/**
+ * @brief A position in a linear allocator, in bytes from its base
+ * 
+ */
+using Marker = MemSize;
+
+/**
+ * @brief Alignment used when none is requested, suitable for any scalar type
+ * 
+ */
+static constexpr MemSize DefaultAlignment = alignof(std::max_align_t);
+
+/**
+ * @brief Largest alignment guaranteed by the allocators' backing memory, a cache line
+ * 
+ */
+static constexpr MemSize MaxAlignment = 64;
+
+/**
+ * @brief Checks that the given alignment is a non-zero power of two
+ * 
+ */
+inline constexpr b8 isPowerOfTwo(MemSize value)
+{
+    return value && !(value & (value - 1));
+}
+
+/**
+ * @brief Rounds the given address up to the next multiple of alignment
+ * 
+ * @param address The address to align
+ * @param alignment A power of two
+ */
+inline constexpr ptr alignForward(ptr address, MemSize alignment)
+{
+    return (address + (alignment - 1)) & ~(ptr)(alignment - 1);
+}
 
 /**
  * @brief Memory tags to help profile subsystems memory consumption
  * 
  */
-enum MemoryTag
+enum class MemoryTag : u8
 {
     Logging,
-    Miscellaneous
+    Miscellaneous,
+    Files,
+    Textures,
+    Fonts,
+    Renderer,
+    Scratch,
+    Count
+};
+
+/**
+ * @brief Accounted memory of a tag, aggregated over every thread
+ * 
+ */
+struct DDLS_API MemoryTagStats
+{
+    /** @brief Bytes currently allocated */
+    i64 bytes;
+    /** @brief Bytes ever allocated */
+    u64 totalBytes;
+    u64 allocations;
+    u64 frees;
+};
+
+/**
+ * @brief Per-tag allocation accounting, counters are per thread and lock-free
+ * 
+ */
+class DDLS_API Memory : public Helper
+{
+public:
+    /**
+     * @brief Records an allocation of size bytes owned by the given tag
+     * 
+     */
+    static void TrackAllocation(MemoryTag tag, u64 size);
+
+    /**
+     * @brief Records a free of size bytes owned by the given tag
+     * 
+     */
+    static void TrackFree(MemoryTag tag, u64 size);
+
+    /**
+     * @brief Sums the counters of every thread for the given tag
+     * 
+     */
+    static MemoryTagStats Stats(MemoryTag tag);
+
+    static const char *TagName(MemoryTag tag);
+
+    /**
+     * @brief Logs the accounted memory of every tag
+     * 
+     */
+    static void Report();
+
+    /**
+     * @brief Allocates from the system heap, accounted under the given tag
+     * 
+     * In debug builds the allocation is guarded and its call site recorded,
+     * leaks are reported when the process exits.
+     * 
+     * @return Ptr The allocation aligned on DefaultAlignment, nullptr on failure
+     */
+    static Ptr Allocate(MemSize size, MemoryTag tag,
+        const std::source_location &site = std::source_location::current());
+
+    /**
+     * @brief Frees an allocation made by Allocate()
+     * 
+     * In debug builds, freeing anything else is reported and ignored.
+     * 
+     */
+    static void Free(Ptr pointer, const std::source_location &site = std::source_location::current());
+
+    /**
+     * @brief Logs every live heap allocation, only tracked in debug builds
+     * 
+     * @return The number of leaked allocations
+     */
+    static u64 ReportLeaks();
 };
 
-} // namespace ddls
\ No newline at end of file
+} // namespace ddls
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+#include "core/assert.h"
+#include "core/error.h"
+#include "core/memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <span>
+
+namespace ddls {
+
+/**
+ * @brief A bounded lock-free queue of byte records, pushed by any thread and popped by a single one
+ *
+ * Records are copied into a ring of fixed-size cells, a record spanning as many consecutive
+ * cells as it needs. Producers reserve their cells with a single compare-and-swap and never
+ * wait on each other, a full queue is reported rather than grown.
+ *
+ * Each cell carries a sequence number telling which position of the ring it is ready for,
+ * after Dmitry Vyukov's bounded queue.
+ *
+ */
+class MpscQueue
+{
+public:
+    static constexpr u64 CellSize = 64;
+    // Bytes of a cell left for the record, past its sequence number
+    static constexpr u64 CellPayload = CellSize - sizeof(std::atomic<u64>);
+
+    /**
+     * @param cellCount The capacity of the ring in cells, a power of two
+     */
+    explicit MpscQueue(u64 cellCount, MemoryTag tag = MemoryTag::Miscellaneous) : _mask(cellCount - 1)
+    {
+        Assert(isPowerOfTwo(cellCount), "The cell count of a queue must be a power of two!");
+
+        _cells = (Cell *) Memory::Allocate(cellCount * sizeof(Cell), tag);
+        if (!_cells) DDLS_THROW(OutOfMemoryException("Failed to allocate queue cells!"));
+        for (u64 i = 0; i < cellCount; i++) new (&_cells[i]) Cell{{i}, {}};
+    }
+
+    ~MpscQueue()
+    {
+        for (u64 i = 0; i <= _mask; i++) _cells[i].~Cell();
+        Memory::Free(_cells);
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /**
+     * @brief The largest record the queue can hold, filling every cell
+     *
+     */
+    u64 maxRecordSize() const { return (_mask + 1) * CellPayload - sizeof(u32); }
+
+    /**
+     * @brief Copies a record into the queue, from any thread
+     *
+     * @return false if there isn't room for it at the moment, or ever
+     */
+    Boolean tryPush(const void *record, u64 size) { return tryPush({{(const char *) record, (std::size_t) size}}); }
+
+    /**
+     * @brief Copies a record gathered from several parts into the queue, from any thread
+     *
+     */
+    Boolean tryPush(std::initializer_list<std::span<const char>> parts)
+    {
+        u64 size = 0;
+        for (std::span<const char> part : parts) size += part.size();
+        if (size > maxRecordSize()) return false;
+
+        u64 count = cellsFor(size);
+        u64 position = _tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            // Cells are released in order, the whole range is free once its last cell is
+            u64 sequence = cell(position + count - 1).sequence.load(std::memory_order_acquire);
+            i64 lag = (i64) (sequence - (position + count - 1));
+            if (lag == 0)
+            {
+                if (_tail.compare_exchange_weak(position, position + count, std::memory_order_relaxed)) break;
+            }
+            else if (lag < 0)
+            {
+                // Still holding the previous lap's records
+                return false;
+            }
+            else
+            {
+                position = _tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        u32 length = (u32) size;
+        std::memcpy(cell(position).payload, &length, sizeof(u32));
+        u64 index = 0, used = sizeof(u32);
+        for (std::span<const char> part : parts)
+        {
+            for (u64 offset = 0; offset < part.size();)
+            {
+                if (used == CellPayload)
+                {
+                    index++;
+                    used = 0;
+                }
+                u64 chunk = std::min<u64>(part.size() - offset, CellPayload - used);
+                std::memcpy(cell(position + index).payload + used, part.data() + offset, chunk);
+                used += chunk;
+                offset += chunk;
+            }
+        }
+
+        // The first cell is published last, the consumer sees the whole record once it sees it
+        for (u64 i = count; i-- > 0;) cell(position + i).sequence.store(position + i + 1, std::memory_order_release);
+        _tail.notify_one();
+
+        return true;
+    }
+
+    /**
+     * @brief Copies the oldest record out of the queue, from the consumer thread only
+     *
+     * @param record Room for maxRecordSize() bytes
+     * @return The size of the record, or -1 if none is ready
+     */
+    i64 tryPop(void *record)
+    {
+        Cell &first = cell(_head);
+        if (first.sequence.load(std::memory_order_acquire) != _head + 1) return -1;
+
+        u32 length;
+        std::memcpy(&length, first.payload, sizeof(u32));
+        u64 count = cellsFor(length);
+
+        char *bytes = (char *) record;
+        for (u64 i = 0, offset = 0; i < count; i++)
+        {
+            const char *payload = cell(_head + i).payload;
+            u64 skip = i ? 0 : sizeof(u32);
+
+            u64 chunk = length - offset < CellPayload - skip ? length - offset : CellPayload - skip;
+            std::memcpy(bytes + offset, payload + skip, chunk);
+            offset += chunk;
+        }
+
+        // Ready for the next lap
+        for (u64 i = 0; i < count; i++) cell(_head + i).sequence.store(_head + i + _mask + 1, std::memory_order_release);
+        _head += count;
+
+        return (i64) length;
+    }
+
+    /**
+     * @brief The position past the last cell reserved so far, from any thread
+     *
+     */
+    u64 tail() const { return _tail.load(std::memory_order_acquire); }
+
+    /**
+     * @brief The position past the last cell popped so far, from the consumer thread only
+     *
+     */
+    u64 head() const { return _head; }
+
+    /**
+     * @brief Whether every reserved record has been popped, from the consumer thread only
+     *
+     */
+    Boolean empty() const { return tail() == _head; }
+
+    /**
+     * @brief Blocks the consumer until a record is pushed, unless some already are
+     *
+     * Pushing an empty record is the way to wake it up for anything else.
+     *
+     */
+    void wait() const
+    {
+        u64 tail = _tail.load(std::memory_order_acquire);
+        if (tail == _head) _tail.wait(tail, std::memory_order_acquire);
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<u64> sequence;
+        char payload[CellPayload];
+    };
+
+    static_assert(sizeof(Cell) == CellSize, "Queue cells are padded");
+
+    static u64 cellsFor(u64 size) { return (size + sizeof(u32) + CellPayload - 1) / CellPayload; }
+
+    Cell &cell(u64 position) { return _cells[position & _mask]; }
+
+    Cell *_cells = nullptr;
+    u64 _mask;
+    // Producers and the consumer each own a cache line
+    alignas(MaxAlignment) std::atomic<u64> _tail{0};
+    alignas(MaxAlignment) u64 _head = 0;
+};
+
+} // namespace ddls
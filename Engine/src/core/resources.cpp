@@ -2,17 +2,170 @@
 
 #include "core/log.h"
 #include "core/assert.h"
+#include "core/content_hash.h"
+#include "core/image.h"
+#include "core/memory.h"
+#include "core/texture_cooker.h"
+#include "memory/scratch.h"
+
+#include <algorithm>
+#include <cstdlib>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 namespace ddls {
 
+static u64 sizeOf(const File& file) { return file.size; }
+
+static u64 sizeOf(const Texture& texture) { return texture.size(); }
+
+static void releaseValue(const File& file)
+{
+	Memory::Free(file.data);
+}
+
+static void releaseValue(const Texture& texture)
+{
+	if (texture.cooked)
+	{
+		// Read along with its header
+		Memory::Free(texture.data - sizeof(CookedTextureHeader));
+		return;
+	}
+
+	Memory::TrackFree(MemoryTag::Textures, texture.size());
+	stbi_image_free(texture.data);
+}
+
+template<>
+HashMap<StringId, Resources::Cached<File>>& Resources::cache<File>() { return _files; }
+
+template<>
+HashMap<StringId, Resources::Cached<Texture>>& Resources::cache<Texture>() { return _textures; }
+
+template<>
+HashMap<u64, Resources::Shared<File>>& Resources::shared<File>() { return _sharedFiles; }
+
+template<>
+HashMap<u64, Resources::Shared<Texture>>& Resources::shared<Texture>() { return _sharedTextures; }
+
+template<typename T>
+T Resources::alias(Shared<T>& shared)
+{
+	DedupStats &stats = _dedupStats[(u64)ResourceRef<T>::Class];
+	stats.aliases++;
+	stats.bytesSaved += sizeOf(shared.value);
+	shared.aliases++;
+
+	return shared.value;
+}
+
+template<typename T>
+T Resources::share(const T& value)
+{
+	auto [shared, inserted] = this->shared<T>().tryEmplace(value.contentHash, Shared<T>{value, 1});
+	if (inserted)
+	{
+		_used[(u64)ResourceRef<T>::Class] += sizeOf(value);
+		return value;
+	}
+
+	// Already aliased when the contents were found shared before decoding them
+	if (shared->value.data == value.data) return value;
+
+	releaseValue(value);
+	return alias(*shared);
+}
+
+template<typename T>
+void Resources::unshare(const T& value)
+{
+	Shared<T> *shared = this->shared<T>().find(value.contentHash);
+	if (--shared->aliases)
+	{
+		DedupStats &stats = _dedupStats[(u64)ResourceRef<T>::Class];
+		stats.aliases--;
+		stats.bytesSaved -= sizeOf(value);
+		return;
+	}
+
+	_used[(u64)ResourceRef<T>::Class] -= sizeOf(value);
+	releaseValue(value);
+	this->shared<T>().erase(value.contentHash);
+}
+
+template<typename T>
+const T& Resources::insert(StringId id, const T& value, std::vector<StringId>& evicted)
+{
+	T stored = share(value);
+	auto [cached, inserted] = cache<T>().tryEmplace(id, Cached<T>{stored, 0, ++_clock});
+	if (!inserted)
+	{
+		// Another thread loaded it meanwhile
+		unshare(stored);
+		cached->lastUse = _clock;
+		return cached->value;
+	}
+
+	evict<T>(id, evicted);
+
+	// Evicting moves entries around
+	return cache<T>().find(id)->value;
+}
+
+template<typename T>
+void Resources::evict(StringId keep, std::vector<StringId>& evicted)
+{
+	u64 &used = _used[(u64)ResourceRef<T>::Class];
+	u64 budget = _budgets[(u64)ResourceRef<T>::Class];
+	if (used <= budget) return;
+
+	// Least recently used first, skipping referenced resources and the one being handed out
+	std::vector<std::pair<u64, StringId>> candidates;
+	for (auto & entry : cache<T>())
+	{
+		if (!entry.second.references && entry.first != keep) candidates.emplace_back(entry.second.lastUse, entry.first);
+	}
+	std::sort(candidates.begin(), candidates.end());
+
+	for (auto & candidate : candidates)
+	{
+		if (used <= budget) break;
+
+		// Only frees anything once every path sharing the contents is gone
+		unshare(cache<T>().find(candidate.second)->value);
+		cache<T>().erase(candidate.second);
+		evicted.push_back(candidate.second);
+	}
+}
+
+template<typename T>
+ResourceRef<T> Resources::reference(StringId id)
+{
+	Cached<T> *entry = cache<T>().find(id);
+	entry->references++;
+	entry->lastUse = ++_clock;
+
+	return ResourceRef<T>(this, id, entry->value);
+}
+
+Resources::Resources() = default;
+
 Resources::~Resources()
 {
-	for (auto & allocation : _files)
+	// The watcher and workers may still be using the caches
+	_watcher.stop();
+	_workers.reset();
+
+	for (auto & allocation : _sharedFiles)
+	{
+		releaseValue(allocation.second.value);
+	}
+
+	for (auto & allocation : _sharedTextures)
 	{
-		::free(&(allocation.second));
+		releaseValue(allocation.second.value);
 	}
 }
 
@@ -21,57 +174,507 @@ std::filesystem::path Resources::getPath(const char* filePath)
     return cwd().append(filePath);
 }
 
+Boolean Resources::mount(const char* archivePath)
+{
+	auto archive = std::make_unique<Archive>();
+	if (!archive->mount(cwd().append(archivePath)))
+	{
+		Log::Error(LogCategory::Resources, "Cannot mount archive \"", archivePath, "\"!");
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_archives.push_back(std::move(archive));
+
+	return true;
+}
+
 const char* Resources::getFile(const char* filePath)
 {
-	if (_files.count(filePath)) return _files[filePath];
-	std::ifstream file(cwd().append(filePath), std::ios::ate | std::ios::binary);
+	StringId id(filePath);
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		if (Cached<File> *loaded = _files.find(id))
+		{
+			loaded->lastUse = ++_clock;
+			return loaded->value.data;
+		}
+	}
 
-	Assert(file.is_open(), 
+	File file = readFile(filePath);
+	Assert(file.data != nullptr,
 		fmt::format("Cannot open file \"{}\"!", filePath));
 
-	u32 fileSize = (u32)file.tellg();
-	char *buffer = (char*)malloc(fileSize);
+	std::vector<StringId> evicted;
+	const char *data;
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		data = insert(id, file, evicted).data;
+	}
+	notifyEvicted(AssetClass::Files, evicted);
+
+	return data;
+}
+
+const Texture Resources::getTexture(const char* texturePath)
+{
+	StringId id(texturePath);
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		if (Cached<Texture> *loaded = _textures.find(id))
+		{
+			loaded->lastUse = ++_clock;
+			return loaded->value;
+		}
+	}
+
+	const char *failure = nullptr;
+	Texture tex = decodeTexture(texturePath, failure);
+	Assert(tex.data != nullptr,
+		fmt::format("Failed to get texture \"{}\": {}!", texturePath, failure ? failure : "unknown error"));
+
+	std::vector<StringId> evicted;
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		tex = insert(id, tex, evicted);
+	}
+	notifyEvicted(AssetClass::Textures, evicted);
+
+	return tex;
+}
+
+FileRef Resources::acquireFile(const char* filePath)
+{
+	StringId id(filePath);
+	while (true)
+	{
+		getFile(filePath);
+
+		// Another thread may have evicted it in between
+		std::unique_lock<std::mutex> lock(_mutex);
+		if (_files.contains(id)) return reference<File>(id);
+	}
+}
+
+TextureRef Resources::acquireTexture(const char* texturePath)
+{
+	StringId id(texturePath);
+	while (true)
+	{
+		getTexture(texturePath);
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		if (_textures.contains(id)) return reference<Texture>(id);
+	}
+}
+
+std::span<const char> Resources::mapFile(const char* filePath, FileAccess access)
+{
+	StringId id(filePath);
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	// Stored entries are already mapped with their archive
+	const ArchiveEntry *entry = nullptr;
+	if (const Archive *archive = findArchived(id, entry); archive && entry->compression == Compression::None)
+	{
+		return archive->view(*entry);
+	}
+	else if (archive)
+	{
+		// Compressed entries can't be viewed in place, they are decompressed like getFile
+		lock.unlock();
+		const char *contents = getFile(filePath);
+		return {contents, (std::size_t) entry->size};
+	}
+
+	if (const MappedFile *mapped = _mappings.find(id))
+	{
+		mapped->advise(access);
+		return mapped->view();
+	}
+
+	MappedFile file;
+	Assert(file.open(cwd().append(filePath), access),
+		fmt::format("Cannot map file \"{}\"!", filePath));
+
+	return _mappings.tryEmplace(id, std::move(file)).first->view();
+}
+
+FileHandle Resources::loadFileAsync(const char* filePath)
+{
+	StringId id(filePath);
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	auto request = std::make_shared<FileHandle::Request>();
+	if (_files.contains(id))
+	{
+		request->reference = reference<File>(id);
+		request->value = request->reference.get();
+		request->state.store(LoadState::Ready, std::memory_order_release);
+		return FileHandle(request);
+	}
+	auto [pending, inserted] = _pendingFiles.tryEmplace(id, request);
+	if (!inserted) return FileHandle(*pending);
+
+	// The path is copied, the caller's string may not outlive the load
+	workers().submit([this, id, request, path = std::string(filePath)] {
+		File file = readFile(path.c_str());
+
+		std::vector<StringId> evicted;
+		{
+			std::unique_lock<std::mutex> cacheLock(_mutex);
+			if (file.data)
+			{
+				insert(id, file, evicted);
+				request->reference = reference<File>(id);
+				request->value = request->reference.get();
+			}
+			else
+			{
+				Log::Error(LogCategory::Resources, "Cannot open file \"", path, "\"!");
+			}
+			_pendingFiles.erase(id);
+			request->state.store(file.data ? LoadState::Ready : LoadState::Failed, std::memory_order_release);
+		}
+		request->state.notify_all();
+		notifyEvicted(AssetClass::Files, evicted);
+	});
+
+	return FileHandle(request);
+}
+
+TextureHandle Resources::loadTextureAsync(const char* texturePath)
+{
+	StringId id(texturePath);
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	auto request = std::make_shared<TextureHandle::Request>();
+	if (_textures.contains(id))
+	{
+		request->reference = reference<Texture>(id);
+		request->value = request->reference.get();
+		request->state.store(LoadState::Ready, std::memory_order_release);
+		return TextureHandle(request);
+	}
+	auto [pending, inserted] = _pendingTextures.tryEmplace(id, request);
+	if (!inserted) return TextureHandle(*pending);
+
+	workers().submit([this, id, request, path = std::string(texturePath)] {
+		const char *failure = nullptr;
+		Texture tex = decodeTexture(path.c_str(), failure);
+
+		std::vector<StringId> evicted;
+		{
+			std::unique_lock<std::mutex> cacheLock(_mutex);
+			if (tex.data)
+			{
+				insert(id, tex, evicted);
+				request->reference = reference<Texture>(id);
+				request->value = request->reference.get();
+			}
+			else
+			{
+				Log::Error(LogCategory::Resources, "Failed to load texture \"", path, "\": ", failure ? failure : "unknown error");
+			}
+			_pendingTextures.erase(id);
+			request->state.store(tex.data ? LoadState::Ready : LoadState::Failed, std::memory_order_release);
+		}
+		request->state.notify_all();
+		notifyEvicted(AssetClass::Textures, evicted);
+	});
+
+	return TextureHandle(request);
+}
+
+void Resources::free(const char* filePath)
+{
+	StringId id(filePath);
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	if (Cached<File> *file = _files.find(id))
+	{
+		if (file->references)
+		{
+			Log::Warning(LogCategory::Resources, "Not freeing \"", filePath, "\", it is still referenced");
+		}
+		else
+		{
+			unshare(file->value);
+			_files.erase(id);
+		}
+	}
+
+	if (Cached<Texture> *texture = _textures.find(id))
+	{
+		if (texture->references)
+		{
+			Log::Warning(LogCategory::Resources, "Not freeing \"", filePath, "\", it is still referenced");
+		}
+		else
+		{
+			unshare(texture->value);
+			_textures.erase(id);
+		}
+	}
+
+	_mappings.erase(id);
+}
+
+void Resources::setBudget(AssetClass assetClass, u64 bytes)
+{
+	std::vector<StringId> evicted;
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_budgets[(u64)assetClass] = bytes;
+		if (assetClass == AssetClass::Files) evict<File>(StringId(), evicted);
+		else evict<Texture>(StringId(), evicted);
+	}
+	notifyEvicted(assetClass, evicted);
+}
+
+u64 Resources::budget(AssetClass assetClass) const
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	return _budgets[(u64)assetClass];
+}
+
+u64 Resources::used(AssetClass assetClass) const
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	return _used[(u64)assetClass];
+}
+
+DedupStats Resources::dedupStats(AssetClass assetClass) const
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	return _dedupStats[(u64)assetClass];
+}
+
+u32 Resources::addEvictionCallback(EvictionCallback callback)
+{
+	std::unique_lock<std::mutex> lock(_callbackMutex);
+	_evictionCallbacks.emplace_back(_nextCallback, std::move(callback));
+
+	return _nextCallback++;
+}
+
+void Resources::removeEvictionCallback(u32 callback)
+{
+	std::unique_lock<std::mutex> lock(_callbackMutex);
+	std::erase_if(_evictionCallbacks, [callback](const auto & entry) { return entry.first == callback; });
+}
+
+Boolean Resources::watch()
+{
+	return _watcher.watch(cwd(), [this](const std::string& path) { changed(path); });
+}
+
+u32 Resources::addChangeCallback(ChangeCallback callback)
+{
+	std::unique_lock<std::mutex> lock(_callbackMutex);
+	_changeCallbacks.emplace_back(_nextCallback, std::move(callback));
+
+	return _nextCallback++;
+}
+
+void Resources::removeChangeCallback(u32 callback)
+{
+	std::unique_lock<std::mutex> lock(_callbackMutex);
+	std::erase_if(_changeCallbacks, [callback](const auto & entry) { return entry.first == callback; });
+}
+
+void Resources::changed(const std::string& path)
+{
+	// Callbacks are told even about uncached resources, which they may still have built something from
+	Log::Debug(LogCategory::Resources, "\"", path, "\" changed, reloading it");
+	free(path.c_str());
+
+	std::unique_lock<std::mutex> lock(_callbackMutex);
+	for (auto & callback : _changeCallbacks) callback.second(path);
+}
+
+void Resources::release(AssetClass assetClass, StringId id)
+{
+	std::vector<StringId> evicted;
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		if (assetClass == AssetClass::Files)
+		{
+			if (Cached<File> *file = _files.find(id); file && !--file->references) evict<File>(StringId(), evicted);
+		}
+		else
+		{
+			if (Cached<Texture> *texture = _textures.find(id); texture && !--texture->references) evict<Texture>(StringId(), evicted);
+		}
+	}
+	notifyEvicted(assetClass, evicted);
+}
+
+void Resources::notifyEvicted(AssetClass assetClass, const std::vector<StringId>& evicted)
+{
+	if (evicted.empty()) return;
+
+	std::unique_lock<std::mutex> lock(_callbackMutex);
+	for (StringId id : evicted)
+	{
+		for (auto & callback : _evictionCallbacks) callback.second(assetClass, id);
+	}
+}
+
+File Resources::readFile(const char* filePath, MemoryTag tag)
+{
+	const ArchiveEntry *entry = nullptr;
+	const Archive *archive = nullptr;
+	WorkerPool *pool = nullptr;
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		archive = findArchived(StringId(filePath), entry);
+		// Large compressed entries are decoded by the workers as well
+		if (archive && entry->compression != Compression::None) pool = &workers();
+	}
+	if (archive)
+	{
+		char *contents = (char*)Memory::Allocate(entry->size + 1, tag);
+		if (!contents || !archive->read(*entry, contents, pool))
+		{
+			Memory::Free(contents);
+			return File{0, nullptr};
+		}
+		contents[entry->size] = '\0';
+		return File{entry->size, contents, ContentHash::Of(contents, entry->size)};
+	}
+
+	std::ifstream file(cwd().append(filePath), std::ios::ate | std::ios::binary);
+	if (!file.is_open()) return File{0, nullptr};
+
+	u64 fileSize = (u64)file.tellg();
+	// One more byte so that text files can be used as C strings
+	char *buffer = (char*)Memory::Allocate(fileSize + 1, tag);
+	if (!buffer) return File{0, nullptr};
 
 	file.seekg(0);
-	file.read(buffer, fileSize);
+	file.read(buffer, (std::streamsize)fileSize);
+	buffer[fileSize] = '\0';
 
 	file.close();
 
-	_files[filePath] = buffer;
-	return buffer;
+	return File{fileSize, buffer, ContentHash::Of(buffer, fileSize)};
 }
 
-const Texture Resources::getTexture(const char* texturePath)
+Texture Resources::decodeTexture(const char* texturePath, const char*& failure)
 {
-	if (_textures.count(texturePath)) return _textures[texturePath];
-
 	Texture tex{};
 	int width, height, channels;
-	stbi_set_flip_vertically_on_load(true);
-	tex.data = stbi_load(texturePath, &width, &height, &channels, 0);
-	Assert(tex.data != nullptr,
-		fmt::format("Failed to get texture \"{}\"!", texturePath));
+
+	if (TextureCooker::IsCooked(texturePath))
+	{
+		// Already laid out for the GPU, the levels are used where they were read
+		File file = readFile(texturePath, MemoryTag::Textures);
+		if (!file.data) failure = "cannot open or read the file";
+		else if (!TextureCooker::Parse({file.data, file.size}, tex))
+		{
+			failure = "not a valid cooked texture";
+			Memory::Free(file.data);
+			tex = Texture{};
+		}
+		tex.contentHash = file.contentHash;
+		return tex;
+	}
+
+	const ArchiveEntry *entry = nullptr;
+	const Archive *archive = nullptr;
+	WorkerPool *pool = nullptr;
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		archive = findArchived(StringId(texturePath), entry);
+		if (archive && entry->compression != Compression::None) pool = &workers();
+	}
+
+	std::span<const char> encoded;
+	// Compressed entries are only needed until decoded, often by a worker
+	Scratch::Scope scratch;
+	MappedFile mapped;
+	if (archive && entry->compression == Compression::None)
+	{
+		// Decoded straight from the mapped archive
+		encoded = archive->view(*entry);
+	}
+	else if (archive)
+	{
+		Expected<Ptr, AllocError> contents = scratch.arena().tryAllocate(entry->size, DefaultAlignment, false);
+		if (!contents) failure = "not enough memory to read it from its archive";
+		else if (!archive->read(*entry, (char*)contents.value(), pool)) failure = "cannot read it from its archive";
+		else encoded = {(const char*)contents.value(), (std::size_t)entry->size};
+	}
+	else if (mapped.open(cwd().append(texturePath), FileAccess::Sequential))
+	{
+		encoded = mapped.view();
+	}
+	else
+	{
+		failure = "cannot open the file";
+	}
+
+	// Hashed before decoding, so that a texture already loaded under another path isn't decoded again
+	if (!encoded.empty())
+	{
+		tex.contentHash = ContentHash::Of(encoded.data(), encoded.size());
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			if (Shared<Texture> *shared = _sharedTextures.find(tex.contentHash)) return alias(*shared);
+		}
+
+		tex.data = stbi_load_from_memory((const stbi_uc*)encoded.data(), (int)encoded.size(),
+			&width, &height, &channels, 0);
+		// Only meaningful right after stb ran, it's left over from earlier decodes otherwise
+		if (!tex.data) failure = stbi_failure_reason() ? stbi_failure_reason() : "not a valid image";
+	}
+	else if (!failure)
+	{
+		failure = "the file is empty";
+	}
+	if (!tex.data) return tex;
+
+	// GL wants the bottom row first, flipped here as stb's own flag is global to every thread
+	Image::FlipVertically(tex.data, (u64)width * channels, (u32)height);
+	if (channels == 3)
+	{
+		// GPUs have no 3-byte texel format of their own, better expand once than on every upload.
+		// Allocated like stb's own buffers, as it's released with stbi_image_free()
+		unsigned char *expanded = (unsigned char*)malloc((u64)width * height * 4);
+		if (expanded)
+		{
+			Image::ExpandRgbToRgba(tex.data, expanded, (u64)width * height);
+			stbi_image_free(tex.data);
+			tex.data = expanded;
+			channels = 4;
+		}
+	}
+
 	tex.width = (u16)width;
 	tex.height = (u16)height;
 	tex.channels = (u16)channels;
+	Memory::TrackAllocation(MemoryTag::Textures, tex.size());
 
-	_textures[texturePath] = tex;
 	return tex;
 }
 
-void Resources::free(const char* filePath)
+const Archive* Resources::findArchived(StringId id, const ArchiveEntry*& entry) const
 {
-	if (_files.count(filePath))
+	for (auto archive = _archives.rbegin(); archive != _archives.rend(); archive++)
 	{
-		::free(_files[filePath]);
-		_files.erase(filePath);
+		entry = (*archive)->find(id);
+		if (entry) return archive->get();
 	}
 
-	if (_textures.count(filePath))
-	{
-		::free(_textures[filePath].data);
-		_textures.erase(filePath);
-	}
+	return nullptr;
+}
+
+WorkerPool &Resources::workers()
+{
+	if (!_workers) _workers = std::make_unique<WorkerPool>();
+
+	return *_workers;
 }
 
 #ifdef DDLS_PLATFORM_WINDOWS
@@ -108,10 +711,10 @@ std::filesystem::path Resources::cwd()
 
 std::filesystem::path Resources::cwd()
 {
-	u32 size = FILENAME_MAX;
-	char buffer[size];
-	readlink("/proc/self/exe", buffer, size);
-	std::string currentDirectory(buffer);
+	char buffer[FILENAME_MAX];
+	// Not null-terminated
+	ssize_t length = readlink("/proc/self/exe", buffer, sizeof(buffer));
+	std::string currentDirectory(buffer, length > 0 ? (u64)length : 0);
 	return ((std::filesystem::path)currentDirectory).parent_path();
 }
 
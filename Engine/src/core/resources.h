@@ -2,9 +2,23 @@
 
 #include "core/defines.h"
 #include "core/types.h"
+#include "core/assert.h"
+#include "core/archive.h"
+#include "core/file_watcher.h"
+#include "core/hash_map.h"
+#include "core/memory.h"
+#include "core/mapped_file.h"
+#include "core/string_id.h"
+#include "core/worker_pool.h"
 
-#include <map>
+#include <atomic>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <mutex>
+#include <span>
+#include <vector>
 
 namespace ddls {
 
@@ -18,15 +32,237 @@ struct DDLS_API Texture
     u16 height;
     u16 channels;
     unsigned char* data;
+    /** @brief The number of levels, each half the size of the previous one, decoded images have one */
+    u16 mipCount = 1;
+    /** @brief Every row starts at a multiple of this many bytes, as GL_UNPACK_ALIGNMENT */
+    u16 rowAlignment = 1;
+    /** @brief Whether the colors are already multiplied by the alpha */
+    b8 premultiplied = false;
+    /** @brief Whether data follows a cooked texture header, rather than being decoded */
+    b8 cooked = false;
+    /** @brief The hash of the encoded contents, equal for identical textures loaded under different paths */
+    u64 contentHash = 0;
+
+    u16 mipWidth(u16 level) const { return width >> level ? (u16)(width >> level) : (u16)1; }
+
+    u16 mipHeight(u16 level) const { return height >> level ? (u16)(height >> level) : (u16)1; }
+
+    u64 rowPitch(u16 level) const { return alignForward((ptr)mipWidth(level) * channels, rowAlignment); }
+
+    u64 mipSize(u16 level) const { return rowPitch(level) * mipHeight(level); }
+
+    /**
+     * @brief Where a level starts, levels follow each other from the largest
+     * 
+     */
+    u64 mipOffset(u16 level) const
+    {
+        u64 offset = 0;
+        for (u16 previous = 0; previous < level; previous++) offset += mipSize(previous);
+        return offset;
+    }
+
+    const unsigned char* mip(u16 level) const { return data + mipOffset(level); }
+
+    u64 size() const { return mipOffset(mipCount); }
+};
+
+/**
+ * @brief The engine's representation of a loaded file
+ * 
+ */
+struct DDLS_API File
+{
+    u64 size;
+    char* data;
+    /** @brief The hash of the contents, equal for identical files loaded under different paths */
+    u64 contentHash = 0;
+};
+
+/**
+ * @brief The kinds of cached resources, each with its own memory budget
+ * 
+ */
+enum class AssetClass : u8
+{
+    Files,
+    Textures,
+    Count
+};
+
+/**
+ * @brief How much an asset class saves by sharing identical contents
+ * 
+ */
+struct DDLS_API DedupStats
+{
+    /** @brief The number of cached paths sharing the contents of another one */
+    u64 aliases = 0;
+    /** @brief The bytes those paths would take if they had their own copy */
+    u64 bytesSaved = 0;
+};
+
+class Resources;
+
+/**
+ * @brief A reference to a cached resource, which is never evicted while referenced
+ * 
+ * References are move-only, acquire another one to share a resource.
+ * 
+ */
+template<typename T>
+class ResourceRef
+{
+public:
+    static constexpr AssetClass Class = std::is_same_v<T, File> ? AssetClass::Files : AssetClass::Textures;
+
+    ResourceRef() = default;
+    ~ResourceRef() { reset(); }
+
+    ResourceRef(ResourceRef const&)      = delete;
+    void operator=(ResourceRef const&)   = delete;
+
+    ResourceRef(ResourceRef &&other) noexcept { *this = std::move(other); }
+
+    ResourceRef &operator=(ResourceRef &&other) noexcept
+    {
+        std::swap(_owner, other._owner);
+        std::swap(_id, other._id);
+        std::swap(_value, other._value);
+        return *this;
+    }
+
+    /**
+     * @brief Drops the reference, the resource becomes evictable once unreferenced
+     * 
+     */
+    void reset();
+
+    const T &get() const
+    {
+        Assert(_owner, "Getting the resource of an empty reference!");
+        return _value;
+    }
+
+    explicit operator bool() const { return _owner != nullptr; }
+
+private:
+    friend class Resources;
+
+    ResourceRef(Resources *owner, StringId id, const T &value) : _owner(owner), _id(id), _value(value) {}
+
+    Resources *_owner = nullptr;
+    StringId _id;
+    T _value{};
 };
 
+using FileRef = ResourceRef<File>;
+using TextureRef = ResourceRef<Texture>;
+
+/**
+ * @brief The progress of an asynchronous load
+ * 
+ */
+enum class LoadState : u8
+{
+    Pending,
+    Ready,
+    Failed
+};
+
+/**
+ * @brief A shared handle to a resource loaded in the background, polled by its users
+ * 
+ * Every handle to the same path shares the same request, whose value is owned by Resources
+ * once ready, exactly as if it had been loaded synchronously.
+ * 
+ */
+template<typename T>
+class LoadHandle
+{
+public:
+    LoadHandle() = default;
+
+    /**
+     * @brief The state of the load, Failed for an empty handle
+     * 
+     */
+    LoadState state() const
+    {
+        return _request ? _request->state.load(std::memory_order_acquire) : LoadState::Failed;
+    }
+
+    bool ready() const { return state() == LoadState::Ready; }
+
+    /**
+     * @brief Blocks until the load is over
+     * 
+     */
+    void wait() const
+    {
+        if (_request) _request->state.wait(LoadState::Pending, std::memory_order_acquire);
+    }
+
+    /**
+     * @brief The loaded resource, the handle must be ready
+     * 
+     */
+    const T &get() const
+    {
+        Assert(ready(), "Getting a resource that isn't loaded!");
+        return _request->value;
+    }
+
+private:
+    friend class Resources;
+
+    struct Request
+    {
+        std::atomic<LoadState> state{LoadState::Pending};
+        T value{};
+        // Keeps the value cached for as long as a handle to it exists
+        ResourceRef<T> reference;
+    };
+
+    explicit LoadHandle(std::shared_ptr<Request> request) : _request(std::move(request)) {}
+
+    std::shared_ptr<Request> _request;
+};
+
+using FileHandle = LoadHandle<File>;
+using TextureHandle = LoadHandle<Texture>;
+
 /**
  * @brief A resource management class
  *
+ * Loaded resources are cached by path, the cache is shared with the loading workers
+ * so every method may be called from any thread.
+ *
+ * Each asset class may be given a byte budget, the least recently used resources are
+ * then evicted to fit it, except those held by a ResourceRef or a LoadHandle.
+ * Pointers handed out by getFile() are only valid until the next load in that case.
+ *
+ * Contents are hashed on load, paths with identical contents share a single copy,
+ * which is counted once against the budget and released with its last path.
+ *
  */
 class DDLS_API Resources
 {
 public:
+    static constexpr u64 Unlimited = ~0ull;
+
+    /**
+     * @brief Called after a resource is evicted, possibly from a loading worker
+     *
+     */
+    using EvictionCallback = std::function<void(AssetClass assetClass, StringId id)>;
+
+    /**
+     * @brief Called from the watching thread after a watched resource changed on disk
+     *
+     */
+    using ChangeCallback = std::function<void(const std::string& path)>;
+
     ~Resources();
 
     /**
@@ -44,12 +280,34 @@ public:
 
     std::filesystem::path getPath(const char* filePath);
 
+    /**
+     * @brief Mounts an archive, its entries are resolved before loose files
+     *
+     * The most recently mounted archive wins when several contain the same name.
+     *
+     * @param archivePath The archive's path, relative to the executable
+     * @return false if it isn't a valid archive
+     */
+    Boolean mount(const char* archivePath);
+
     /**
      * @brief Gets the requested file, allocating its contents if needed
      *
+     * The contents are null-terminated, past the file's size.
+     *
      */
     const char* getFile(const char* filePath);
 
+    /**
+     * @brief Maps the requested file into memory if needed and views it without copying
+     *
+     * The view is not null-terminated and stays valid until the file is freed.
+     * Compressed archive entries are decompressed once, then viewed like getFile().
+     *
+     * @param access How the file is going to be read, to tune read-ahead
+     */
+    std::span<const char> mapFile(const char* filePath, FileAccess access = FileAccess::Sequential);
+
     /**
      * @brief Gets the requested texture, allocating its contents if needed
      *
@@ -57,16 +315,180 @@ public:
     const Texture getTexture(const char* texturePath);
 
     /**
-     * @brief Frees the given resource
+     * @brief Reads the requested file on a worker, ready at once if it's already loaded
+     *
+     */
+    FileHandle loadFileAsync(const char* filePath);
+
+    /**
+     * @brief Decodes the requested texture on a worker, ready at once if it's already loaded
+     *
+     * Uploading it to the GPU is left to the render thread once the handle is ready.
+     *
+     */
+    TextureHandle loadTextureAsync(const char* texturePath);
+
+    /**
+     * @brief Gets the requested file and keeps it cached while referenced
+     *
+     */
+    FileRef acquireFile(const char* filePath);
+
+    /**
+     * @brief Gets the requested texture and keeps it cached while referenced
+     *
+     */
+    TextureRef acquireTexture(const char* texturePath);
+
+    /**
+     * @brief Frees the given resource, loads in flight aren't cancelled
+     *
+     * Referenced resources are kept.
      *
      */
     void free(const char* filePath);
 
+    /**
+     * @brief Sets the number of bytes an asset class may keep cached, evicting to fit it
+     *
+     */
+    void setBudget(AssetClass assetClass, u64 bytes);
+
+    u64 budget(AssetClass assetClass) const;
+
+    /**
+     * @brief The number of bytes an asset class currently keeps cached
+     *
+     */
+    u64 used(AssetClass assetClass) const;
+
+    /**
+     * @brief How many cached paths of an asset class share their contents, and the bytes it saves
+     *
+     */
+    DedupStats dedupStats(AssetClass assetClass) const;
+
+    /**
+     * @brief Registers a callback run after every eviction, such as to release GPU copies
+     *
+     * @return An identifier to remove the callback with
+     */
+    u32 addEvictionCallback(EvictionCallback callback);
+
+    /**
+     * @brief Removes a callback, waiting for any running invocation of it to return
+     *
+     */
+    void removeEvictionCallback(u32 callback);
+
+    /**
+     * @brief Starts reloading the resources changed on disk under the resource root
+     *
+     * Changed resources are freed from the cache, unless referenced, so that the next
+     * request loads them again, and change callbacks are told to rebuild what they made of them.
+     *
+     * @return false if files cannot be watched on this platform
+     */
+    Boolean watch();
+
+    /**
+     * @brief Registers a callback run after a watched resource changed
+     *
+     * @return An identifier to remove the callback with
+     */
+    u32 addChangeCallback(ChangeCallback callback);
+
+    /**
+     * @brief Removes a callback, waiting for any running invocation of it to return
+     *
+     */
+    void removeChangeCallback(u32 callback);
+
 private:
-    Resources() = default;
-    std::map<const char*, char*> _files;
-    std::map<const char*, Texture> _textures;
+    template<typename T>
+    friend class ResourceRef;
+
+    template<typename T>
+    struct Cached
+    {
+        T value;
+        u32 references;
+        u64 lastUse;
+    };
+
+    // Contents shared by every cached path they were loaded from
+    template<typename T>
+    struct Shared
+    {
+        T value;
+        u32 aliases;
+    };
+
+    Resources();
+    File readFile(const char* filePath, MemoryTag tag = MemoryTag::Files);
+    // Sets failure to why nothing was decoded
+    Texture decodeTexture(const char* texturePath, const char*& failure);
+    WorkerPool &workers();
+    // Require _mutex
+    const Archive* findArchived(StringId id, const ArchiveEntry*& entry) const;
+    template<typename T>
+    HashMap<StringId, Cached<T>>& cache();
+    template<typename T>
+    HashMap<u64, Shared<T>>& shared();
+    template<typename T>
+    T alias(Shared<T>& shared);
+    template<typename T>
+    T share(const T& value);
+    template<typename T>
+    void unshare(const T& value);
+    template<typename T>
+    const T& insert(StringId id, const T& value, std::vector<StringId>& evicted);
+    template<typename T>
+    void evict(StringId keep, std::vector<StringId>& evicted);
+    template<typename T>
+    ResourceRef<T> reference(StringId id);
+
+    void release(AssetClass assetClass, StringId id);
+    void notifyEvicted(AssetClass assetClass, const std::vector<StringId>& evicted);
+    void changed(const std::string& path);
+
+    mutable std::mutex _mutex;
+    // Keyed on the path contents, not on the address of the string holding it
+    HashMap<StringId, Cached<File>> _files{MemoryTag::Files};
+    HashMap<StringId, Cached<Texture>> _textures{MemoryTag::Textures};
+    // Keyed on the content hash, own the cached buffers
+    HashMap<u64, Shared<File>> _sharedFiles{MemoryTag::Files};
+    HashMap<u64, Shared<Texture>> _sharedTextures{MemoryTag::Textures};
+    DedupStats _dedupStats[(u64)AssetClass::Count]{};
+    u64 _budgets[(u64)AssetClass::Count]{Unlimited, Unlimited};
+    u64 _used[(u64)AssetClass::Count]{};
+    // Stamps every use for LRU eviction
+    u64 _clock = 0;
+
+    // Held while callbacks run, so that removing one waits for it to return
+    std::mutex _callbackMutex;
+    std::vector<std::pair<u32, EvictionCallback>> _evictionCallbacks;
+    std::vector<std::pair<u32, ChangeCallback>> _changeCallbacks;
+    u32 _nextCallback = 0;
+    FileWatcher _watcher;
+
+    HashMap<StringId, MappedFile> _mappings{MemoryTag::Files};
+    // Never unmounted, so entries can be read without holding the lock
+    std::vector<std::unique_ptr<Archive>> _archives;
+    // Loads in flight, so that requesting a path twice shares its request
+    HashMap<StringId, std::shared_ptr<FileHandle::Request>> _pendingFiles{MemoryTag::Files};
+    HashMap<StringId, std::shared_ptr<TextureHandle::Request>> _pendingTextures{MemoryTag::Textures};
+    // Started on the first asynchronous load, and stopped before the caches are released
+    std::unique_ptr<WorkerPool> _workers;
     static std::filesystem::path cwd();
 };
 
+template<typename T>
+void ResourceRef<T>::reset()
+{
+    if (!_owner) return;
+    _owner->release(Class, _id);
+    _owner = nullptr;
+}
+
 } // namespace ddls
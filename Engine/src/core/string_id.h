@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace ddls {
+
+/**
+ * @brief A string identified by its 64-bit FNV-1a hash
+ *
+ * Two ids compare equal when their contents do, wherever the strings live,
+ * and hashing happens at compile time for literals used in constant expressions.
+ *
+ */
+class StringId
+{
+public:
+    static constexpr u64 OffsetBasis = 14695981039346656037ull;
+    static constexpr u64 Prime = 1099511628211ull;
+
+    constexpr StringId() = default;
+
+    constexpr StringId(std::string_view string) : _value(hash(string)) {}
+
+    constexpr StringId(const char *string) : StringId(std::string_view(string)) {}
+
+    StringId(const std::string &string) : StringId(std::string_view(string)) {}
+
+    constexpr u64 value() const { return _value; }
+
+    constexpr bool operator==(const StringId &other) const = default;
+
+    constexpr auto operator<=>(const StringId &other) const = default;
+
+    /**
+     * @brief Hashes a string with FNV-1a
+     *
+     */
+    static constexpr u64 hash(std::string_view string)
+    {
+        u64 value = OffsetBasis;
+        for (char c : string)
+        {
+            value ^= (u8) c;
+            value *= Prime;
+        }
+        return value;
+    }
+
+private:
+    u64 _value = OffsetBasis;
+};
+
+inline namespace literals {
+
+/**
+ * @brief Hashes a literal at compile time, "shader.vert.glsl"_sid
+ *
+ */
+consteval StringId operator""_sid(const char *string, std::size_t length)
+{
+    return StringId(std::string_view(string, length));
+}
+
+} // namespace literals
+
+} // namespace ddls
+
+template<>
+struct std::hash<ddls::StringId>
+{
+    std::size_t operator()(const ddls::StringId &id) const noexcept { return (std::size_t) id.value(); }
+};
@@ -0,0 +1,165 @@
+#include "core/texture_cooker.h"
+
+#include "core/image.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ddls {
+
+// Alpha is linear whatever the encoding of the colors, it is the last of 2 or 4 channels
+static Boolean hasAlpha(u16 channels)
+{
+    return channels == 2 || channels == 4;
+}
+
+static void decodeSrgb(const u8 *source, f32 *destination, u64 pixelCount, u16 channels)
+{
+    Image::SrgbToLinear(source, destination, pixelCount * channels);
+    if (!hasAlpha(channels)) return;
+    for (u64 i = channels - 1u; i < pixelCount * channels; i += channels) destination[i] = source[i] / 255.0f;
+}
+
+static void encodeSrgb(const f32 *source, u8 *destination, u64 pixelCount, u16 channels)
+{
+    Image::LinearToSrgb(source, destination, pixelCount * channels);
+    if (!hasAlpha(channels)) return;
+    for (u64 i = channels - 1u; i < pixelCount * channels; i += channels)
+        destination[i] = (u8) (std::clamp(source[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+std::vector<char> TextureCooker::Cook(const u8 *pixels, u16 width, u16 height, u16 channels,
+    const TextureCookOptions &options)
+{
+    Assert(channels >= 1 && channels <= 4, fmt::format("Cannot cook {} channels!", channels));
+    Assert(width && height, "Cannot cook an empty texture!");
+    Assert(isPowerOfTwo(options.rowAlignment) && options.rowAlignment <= 8,
+        fmt::format("Row alignment {} must be a power of two up to 8!", options.rowAlignment));
+
+    std::vector<u8> expanded;
+    if (channels == 3 && options.expandRgb)
+    {
+        expanded.resize((u64) width * height * 4);
+        Image::ExpandRgbToRgba(pixels, expanded.data(), (u64) width * height);
+        pixels = expanded.data();
+        channels = 4;
+    }
+
+    Texture layout{};
+    layout.width = width;
+    layout.height = height;
+    layout.channels = channels;
+    layout.rowAlignment = options.rowAlignment;
+    // Only the alpha of luminance-alpha and RGBA images can be premultiplied
+    layout.premultiplied = options.premultiply && hasAlpha(channels);
+    if (options.mipmaps)
+    {
+        for (u16 largest = std::max(width, height); largest > 1; largest /= 2) layout.mipCount++;
+    }
+
+    CookedTextureHeader header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.width = width;
+    header.height = height;
+    header.channels = channels;
+    header.mipCount = layout.mipCount;
+    header.rowAlignment = layout.rowAlignment;
+    header.flags = layout.premultiplied ? Premultiplied : 0;
+    header.dataSize = layout.size();
+
+    std::vector<char> cooked(sizeof(header) + header.dataSize, 0);
+    std::memcpy(cooked.data(), &header, sizeof(header));
+    layout.data = (unsigned char *) cooked.data() + sizeof(header);
+
+    // Levels are filtered tightly packed, then copied row by row into the padded layout
+    std::vector<u8> level(pixels, pixels + (u64) width * height * channels);
+    // sRGB colors are averaged and premultiplied as linear floats, or the levels come out darker.
+    // An untouched first level is kept as it was, rather than going through a round trip.
+    Boolean linear = options.srgb && (layout.premultiplied || layout.mipCount > 1);
+    std::vector<f32> linearLevel, linearNext;
+    if (linear)
+    {
+        linearLevel.resize(level.size());
+        decodeSrgb(level.data(), linearLevel.data(), (u64) width * height, channels);
+        if (layout.premultiplied)
+        {
+            for (u64 i = 0; i < linearLevel.size(); i += channels)
+            {
+                for (u16 c = 0; c + 1u < channels; c++) linearLevel[i + c] *= linearLevel[i + channels - 1];
+            }
+        }
+    }
+    else if (layout.premultiplied)
+    {
+        Image::Premultiply(level.data(), (u64) width * height, channels);
+    }
+
+    std::vector<u8> next;
+    for (u16 mip = 0; mip < layout.mipCount; mip++)
+    {
+        u16 mipWidth = layout.mipWidth(mip);
+        u16 mipHeight = layout.mipHeight(mip);
+        u64 rowSize = (u64) mipWidth * channels;
+        unsigned char *destination = layout.data + layout.mipOffset(mip);
+        if (linear && (mip || layout.premultiplied))
+        {
+            level.resize(linearLevel.size());
+            encodeSrgb(linearLevel.data(), level.data(), (u64) mipWidth * mipHeight, channels);
+        }
+        for (u16 y = 0; y < mipHeight; y++)
+        {
+            std::memcpy(destination + y * layout.rowPitch(mip), level.data() + y * rowSize, rowSize);
+        }
+
+        if (mip + 1u == layout.mipCount) break;
+        u64 nextSize = (u64) layout.mipWidth((u16) (mip + 1)) * layout.mipHeight((u16) (mip + 1)) * channels;
+        if (linear)
+        {
+            linearNext.resize(nextSize);
+            Image::Downsample(linearLevel.data(), mipWidth, mipHeight, channels, linearNext.data());
+            linearLevel.swap(linearNext);
+            continue;
+        }
+        next.resize(nextSize);
+        Image::Downsample(level.data(), mipWidth, mipHeight, channels, next.data());
+        level.swap(next);
+    }
+
+    return cooked;
+}
+
+Boolean TextureCooker::Parse(std::span<const char> contents, Texture &texture)
+{
+    CookedTextureHeader header;
+    if (contents.size() < sizeof(header)) return false;
+    std::memcpy(&header, contents.data(), sizeof(header));
+
+    if (header.magic != Magic || header.version != Version) return false;
+    if (header.channels < 1 || header.channels > 4 || !header.width || !header.height) return false;
+    if (!isPowerOfTwo(header.rowAlignment) || header.rowAlignment > 8) return false;
+
+    Texture parsed{};
+    parsed.width = header.width;
+    parsed.height = header.height;
+    parsed.channels = header.channels;
+    parsed.rowAlignment = header.rowAlignment;
+    parsed.premultiplied = (header.flags & Premultiplied) != 0;
+    parsed.cooked = true;
+
+    // Levels stop at 1x1
+    u16 maxMipCount = 1;
+    for (u16 largest = std::max(header.width, header.height); largest > 1; largest /= 2) maxMipCount++;
+    if (!header.mipCount || header.mipCount > maxMipCount) return false;
+    parsed.mipCount = header.mipCount;
+
+    if (header.dataSize != parsed.size() || contents.size() - sizeof(header) < header.dataSize) return false;
+    // Textures are never written through, contents may well be a read-only mapping
+    parsed.data = const_cast<unsigned char *>((const unsigned char *) contents.data()) + sizeof(header);
+
+    texture = parsed;
+
+    return true;
+}
+
+} // namespace ddls
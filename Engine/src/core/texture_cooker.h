@@ -0,0 +1,94 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+#include "core/error.h"
+#include "core/resources.h"
+#include "utils/helper.h"
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ddls {
+
+/**
+ * @brief The start of a cooked texture, followed by its levels laid out as Texture describes them
+ * 
+ * Cooked textures are little-endian, like archives.
+ * 
+ */
+struct CookedTextureHeader
+{
+    u32 magic;
+    u32 version;
+    u16 width;
+    u16 height;
+    u16 channels;
+    u16 mipCount;
+    u16 rowAlignment;
+    u16 flags;
+    u32 reserved;
+    /** @brief The size of every level together */
+    u64 dataSize;
+};
+
+static_assert(sizeof(CookedTextureHeader) == 32, "The cooked texture layout must not depend on padding");
+
+/**
+ * @brief How an image is cooked
+ * 
+ */
+struct TextureCookOptions
+{
+    /** @brief Generates every level down to 1x1 */
+    Boolean mipmaps = true;
+    /** @brief Multiplies the colors by the alpha, before filtering the levels so they don't bleed */
+    Boolean premultiply = false;
+    /** @brief A power of two up to 8, 4 matches GL's default unpack alignment */
+    u16 rowAlignment = 4;
+    /** @brief Adds an opaque alpha to RGB images, as GPUs store them anyway */
+    Boolean expandRgb = true;
+    /** @brief The colors are sRGB encoded and filtered in linear space, off for normal maps and other data */
+    Boolean srgb = true;
+};
+
+/**
+ * @brief Converts decoded images to a layout the GPU takes as is, and reads it back
+ * 
+ * Loading a cooked texture is a read and a header check, there is nothing left to decode,
+ * filter or convert. A mapped cooked file can be copied straight into a staging buffer.
+ * 
+ */
+class DDLS_API TextureCooker : public Helper
+{
+public:
+    static constexpr u32 Magic = 0x58455444; // "DTEX"
+    static constexpr u32 Version = 1;
+    static constexpr const char *Extension = ".dtex";
+
+    static constexpr u16 Premultiplied = 1 << 0;
+
+    /**
+     * @brief Cooks tightly packed 8-bit pixels with 1 to 4 channels, the bottom row first
+     * 
+     * @return The cooked texture, header included
+     */
+    static std::vector<char> Cook(const u8 *pixels, u16 width, u16 height, u16 channels,
+        const TextureCookOptions &options = {});
+
+    /**
+     * @brief Validates a cooked texture and describes it, pointing into contents without copying
+     * 
+     * @return false if contents isn't a complete cooked texture of a supported version
+     */
+    static Boolean Parse(std::span<const char> contents, Texture &texture);
+
+    /**
+     * @brief Whether a path names a cooked texture, by its extension
+     * 
+     */
+    static Boolean IsCooked(std::string_view path) { return path.ends_with(Extension); }
+};
+
+} // namespace ddls
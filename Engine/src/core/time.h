@@ -3,6 +3,7 @@
 #include "core/defines.h"
 
 #include <chrono>
+#include <ctime>
 #include <string>
 #include <iomanip>
 #include <sstream>
@@ -109,13 +110,28 @@ public:
 	 */
 	static std::string GetDateTime(const std::string &format = "%Y-%m-%d %H:%M:%S") {
 		auto now = std::chrono::system_clock::now();
-		auto timeT = std::chrono::system_clock::to_time_t(now);
+		std::tm local = LocalTime(std::chrono::system_clock::to_time_t(now));
 
 		std::stringstream ss;
-		ss << std::put_time(localtime(&timeT), format.c_str());
+		ss << std::put_time(&local, format.c_str());
 		return ss.str();
 	}
 
+	/**
+	 * Converts a calendar time to the local time zone, unlike localtime() it may be called from any thread.
+	 * @param time The calendar time.
+	 * @return The local time.
+	 */
+	static std::tm LocalTime(std::time_t time) {
+		std::tm local{};
+#ifdef DDLS_PLATFORM_WINDOWS
+		localtime_s(&local, &time);
+#else
+		localtime_r(&time, &local);
+#endif
+		return local;
+	}
+
 	template<typename Rep, typename Period>
 	constexpr explicit operator std::chrono::duration<Rep, Period>() const {
 		return std::chrono::duration_cast<std::chrono::duration<Rep, Period>>(value);
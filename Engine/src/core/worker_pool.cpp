@@ -0,0 +1,58 @@
+#include "core/worker_pool.h"
+
+namespace ddls {
+
+WorkerPool::WorkerPool(u32 threadCount)
+{
+    if (!threadCount) threadCount = defaultThreadCount();
+
+    _threads.reserve(threadCount);
+    for (u32 i = 0; i < threadCount; i++) _threads.emplace_back(&WorkerPool::run, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopping = true;
+        _jobs.clear();
+    }
+    _condition.notify_all();
+
+    for (std::thread &thread : _threads) thread.join();
+}
+
+void WorkerPool::submit(std::function<void()> job)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _jobs.push_back(std::move(job));
+    }
+    _condition.notify_one();
+}
+
+u32 WorkerPool::defaultThreadCount()
+{
+    u32 hardwareThreads = std::thread::hardware_concurrency();
+
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+void WorkerPool::run()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+            if (_stopping) return;
+
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        job();
+    }
+}
+
+} // namespace ddls
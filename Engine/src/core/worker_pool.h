@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/types.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ddls {
+
+/**
+ * @brief A fixed set of threads running submitted jobs in submission order
+ * 
+ * Jobs still queued when the pool is destroyed are dropped, running ones are joined.
+ * 
+ */
+class DDLS_API WorkerPool
+{
+public:
+    /**
+     * @param threadCount The number of workers, defaultThreadCount() if 0
+     */
+    explicit WorkerPool(u32 threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /**
+     * @brief Queues a job, run by the first idle worker
+     * 
+     */
+    void submit(std::function<void()> job);
+
+    u32 threadCount() const { return (u32) _threads.size(); }
+
+    /**
+     * @brief One worker per hardware thread, leaving one for the calling thread
+     * 
+     */
+    static u32 defaultThreadCount();
+
+private:
+    void run();
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<std::function<void()>> _jobs;
+    std::vector<std::thread> _threads;
+    bool _stopping = false;
+};
+
+} // namespace ddls
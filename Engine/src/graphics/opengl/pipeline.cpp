@@ -3,33 +3,91 @@
 #include "core/resources.h"
 #include "core/log.h"
 
+#include <string>
+#include <string_view>
+
 #include <glad/glad.h>
 
 namespace ddls::gl {
 
 static u32 createShader(const char *filePath, GLenum type);
 
-Pipeline::Pipeline(const char *vertexShaderPath, const char *fragmentShaderPath)
+Pipeline::Pipeline(const char *vertexShaderPath, const char *fragmentShaderPath):
+    _vertexShaderPath(vertexShaderPath),
+    _fragmentShaderPath(fragmentShaderPath)
+{
+    _handle = link();
+}
+
+Boolean Pipeline::uses(StringId shaderPath) const
+{
+    return shaderPath == StringId(_vertexShaderPath) || shaderPath == StringId(_fragmentShaderPath);
+}
+
+Boolean Pipeline::reload()
+{
+    u32 program = link();
+    if (!program)
+    {
+        Log::Warning(LogCategory::Renderer, "Keeping the previous build of \"", _vertexShaderPath, "\" and \"", _fragmentShaderPath, "\"");
+        return false;
+    }
+
+    glDeleteProgram(_handle);
+    _handle = program;
+
+    return true;
+}
+
+u32 Pipeline::link()
 {
-    u32 vertexShader = createShader(vertexShaderPath, GL_VERTEX_SHADER);
-    u32 fragmentShader = createShader(fragmentShaderPath, GL_FRAGMENT_SHADER);
+    u32 vertexShader = createShader(_vertexShaderPath.c_str(), GL_VERTEX_SHADER);
+    u32 fragmentShader = createShader(_fragmentShaderPath.c_str(), GL_FRAGMENT_SHADER);
+
+    u32 program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
 
-    _handle = glCreateProgram();
-    glAttachShader(_handle, vertexShader);
-    glAttachShader(_handle, fragmentShader);
-    glLinkProgram(_handle);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
 
     i32 success;
     char infoLog[512];
-    glGetProgramiv(_handle, GL_LINK_STATUS, &success);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
 
     if (!success) {
-        glGetProgramInfoLog(_handle, 512, NULL, infoLog);
-        Log::Error("Program linking error: ", infoLog);
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        Log::Error(LogCategory::Renderer, "Program linking error: ", infoLog);
+        glDeleteProgram(program);
+        return 0;
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    // Resolve every active uniform once instead of querying GL by name on each set
+    i32 uniformCount = 0;
+    i32 maxNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::string name((u64) maxNameLength, '\0');
+    _uniforms.clear();
+    _uniforms.reserve((u64) uniformCount);
+    for (i32 i = 0; i < uniformCount; i++)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, (u32) i, maxNameLength, &length, &size, &type, name.data());
+        i32 uniformLocation = glGetUniformLocation(program, name.c_str());
+        // Members of uniform blocks have no location
+        if (uniformLocation < 0) continue;
+
+        std::string_view uniform(name.data(), (u64) length);
+        _uniforms[uniform] = uniformLocation;
+        // Arrays are reported as "name[0]" but are usually set by their bare name
+        if (uniform.ends_with("[0]")) _uniforms[uniform.substr(0, uniform.size() - 3)] = uniformLocation;
+    }
+
+    return program;
 }
 
 Pipeline::~Pipeline()
@@ -42,62 +100,71 @@ void Pipeline::bind() const
     glUseProgram(_handle);
 }
 
-void Pipeline::setBool(const std::string &uniform, b8 value) const
+i32 Pipeline::location(StringId uniform) const
+{
+    const i32 *uniformLocation = _uniforms.find(uniform);
+    return uniformLocation ? *uniformLocation : -1;
+}
+
+void Pipeline::setBool(StringId uniform, b8 value) const
 {
-    glUniform1i(glGetUniformLocation(_handle, uniform.c_str()), (i32) value);
+    glUniform1i(location(uniform), (i32) value);
 }
-void Pipeline::setInt(const std::string &uniform, i32 value) const
+void Pipeline::setInt(StringId uniform, i32 value) const
 {
-    glUniform1i(glGetUniformLocation(_handle, uniform.c_str()), value);
+    glUniform1i(location(uniform), value);
 }
-void Pipeline::setFloat(const std::string &uniform, f32 value) const
+void Pipeline::setFloat(StringId uniform, f32 value) const
 {
-    glUniform1f(glGetUniformLocation(_handle, uniform.c_str()), value);
+    glUniform1f(location(uniform), value);
 }
-void Pipeline::setVec2(const std::string &name, const vec2 &value) const
+void Pipeline::setVec2(StringId uniform, const vec2 &value) const
 { 
-    glUniform2fv(glGetUniformLocation(_handle, name.c_str()), 1, &value[0]); 
+    glUniform2fv(location(uniform), 1, &value[0]); 
 }
-void Pipeline::setVec2(const std::string &name, float x, float y) const
+void Pipeline::setVec2(StringId uniform, float x, float y) const
 { 
-    glUniform2f(glGetUniformLocation(_handle, name.c_str()), x, y); 
+    glUniform2f(location(uniform), x, y); 
 }
-void Pipeline::setVec3(const std::string &name, const vec3 &value) const
+void Pipeline::setVec3(StringId uniform, const vec3 &value) const
 { 
-    glUniform3fv(glGetUniformLocation(_handle, name.c_str()), 1, &value[0]); 
+    glUniform3fv(location(uniform), 1, &value[0]); 
 }
-void Pipeline::setVec3(const std::string &name, float x, float y, float z) const
+void Pipeline::setVec3(StringId uniform, float x, float y, float z) const
 { 
-    glUniform3f(glGetUniformLocation(_handle, name.c_str()), x, y, z); 
+    glUniform3f(location(uniform), x, y, z); 
 }
-void Pipeline::setVec4(const std::string &name, const vec4 &value) const
+void Pipeline::setVec4(StringId uniform, const vec4 &value) const
 { 
-    glUniform4fv(glGetUniformLocation(_handle, name.c_str()), 1, &value[0]); 
+    glUniform4fv(location(uniform), 1, &value[0]); 
 }
-void Pipeline::setVec4(const std::string &name, float x, float y, float z, float w) const
+void Pipeline::setVec4(StringId uniform, float x, float y, float z, float w) const
 { 
-    glUniform4f(glGetUniformLocation(_handle, name.c_str()), x, y, z, w); 
+    glUniform4f(location(uniform), x, y, z, w); 
 }
-void Pipeline::setMat2(const std::string &name, const mat2 &mat) const
+void Pipeline::setMat2(StringId uniform, const mat2 &mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(_handle, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(location(uniform), 1, GL_FALSE, &mat[0][0]);
 }
-void Pipeline::setMat3(const std::string &name, const mat3 &mat) const
+void Pipeline::setMat3(StringId uniform, const mat3 &mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(_handle, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(location(uniform), 1, GL_FALSE, &mat[0][0]);
 }
-void Pipeline::setMat4(const std::string &name, const mat4 &mat) const
+void Pipeline::setMat4(StringId uniform, const mat4 &mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(_handle, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(location(uniform), 1, GL_FALSE, &mat[0][0]);
 }
 
 static u32 createShader(const char *filePath, GLenum type)
 {
-    const char *shaderSrc = Resources::Manager().getFile(filePath);
+    std::span<const char> source = Resources::Manager().mapFile(filePath);
+    const char *shaderSrc = source.data();
+    i32 shaderLength = (i32) source.size();
 
     u32 shader = glCreateShader(type);
 
-    glShaderSource(shader, 1, &shaderSrc, nullptr);
+    // Mapped files aren't null-terminated, the length is explicit
+    glShaderSource(shader, 1, &shaderSrc, &shaderLength);
     glCompileShader(shader);
 
     Resources::Manager().free(filePath);
@@ -108,7 +175,7 @@ static u32 createShader(const char *filePath, GLenum type)
 
     if (!success) {
         glGetShaderInfoLog(shader, 512, NULL, infoLog);
-        Log::Error("Vertex shader compilation failed: ", infoLog);
+        Log::Error(LogCategory::Renderer, "Compilation of \"", filePath, "\" failed: ", infoLog);
     }
 
     return shader;
@@ -2,6 +2,8 @@
 
 #include "core/defines.h"
 #include "core/types.h"
+#include "core/hash_map.h"
+#include "core/string_id.h"
 
 #include <glm/glm.hpp>
 
@@ -29,24 +31,55 @@ public:
 	void bind() const;
 
 	/**
-	 * @brief Uniform utility functions
+	 * @brief Whether the pipeline is built from the given shader
 	 *
 	 */
-	void setBool (const std::string &uniform, b8  value) const;
-	void setInt  (const std::string &uniform, i32 value) const;
-	void setFloat(const std::string &uniform, f32 value) const;
-    void setVec2 (const std::string &uniform, const vec2 &value) const;
-    void setVec2 (const std::string &uniform, float x, float y) const;
-    void setVec3 (const std::string &uniform, const vec3 &value) const;
-    void setVec3 (const std::string &uniform, float x, float y, float z) const;
-    void setVec4 (const std::string &uniform, const vec4 &value) const;
-    void setVec4 (const std::string &uniform, float x, float y, float z, float w) const;
-    void setMat2 (const std::string &uniform, const mat2 &mat) const;
-    void setMat3 (const std::string &uniform, const mat3 &mat) const;
-    void setMat4 (const std::string &uniform, const mat4 &mat) const;
+	Boolean uses(StringId shaderPath) const;
+
+	/**
+	 * @brief Rebuilds the program from its shaders in place, keeping the previous one if they fail
+	 *
+	 * Uniform values belong to the program, they have to be set again.
+	 *
+	 * @return false if the shaders didn't compile or link
+	 */
+	Boolean reload();
+
+	/**
+	 * @brief Uniform utility functions, locations are looked up in the table built at link time
+	 *
+	 */
+	void setBool (StringId uniform, b8  value) const;
+	void setInt  (StringId uniform, i32 value) const;
+	void setFloat(StringId uniform, f32 value) const;
+    void setVec2 (StringId uniform, const vec2 &value) const;
+    void setVec2 (StringId uniform, float x, float y) const;
+    void setVec3 (StringId uniform, const vec3 &value) const;
+    void setVec3 (StringId uniform, float x, float y, float z) const;
+    void setVec4 (StringId uniform, const vec4 &value) const;
+    void setVec4 (StringId uniform, float x, float y, float z, float w) const;
+    void setMat2 (StringId uniform, const mat2 &mat) const;
+    void setMat3 (StringId uniform, const mat3 &mat) const;
+    void setMat4 (StringId uniform, const mat4 &mat) const;
 
 private:
+	/**
+	 * @brief The location of an active uniform, -1 which GL ignores otherwise
+	 *
+	 */
+	i32 location(StringId uniform) const;
+
+	/**
+	 * @brief Compiles and links the shaders, filling the uniform table
+	 *
+	 * @return u32 The program, 0 on failure
+	 */
+	u32 link();
+
+	std::string _vertexShaderPath;
+	std::string _fragmentShaderPath;
 	u32 _handle;
+	HashMap<StringId, i32> _uniforms{MemoryTag::Renderer};
 };
 
 } // namespace ddls::gl
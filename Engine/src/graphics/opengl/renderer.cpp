@@ -2,6 +2,7 @@
 
 #include "core/log.h"
 #include "core/resources.h"
+#include "memory/scratch.h"
 
 #include <glad/glad.h>
 #include <stb_image.h>
@@ -11,10 +12,13 @@ extern "C" {
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstring>
 #include "renderer.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_MODULE_H
 
 namespace ddls::gl {
 
@@ -96,12 +100,30 @@ Renderer::Renderer(const RendererConfig& config): ddls::Renderer(config)
 	_pipelineText = new Pipeline("shader.text.vert.glsl", "shader.text.frag.glsl");
 	_projectionText = ortho(0.0f, (f32)_config.width, 0.0f, (f32)_config.height);
 	_pipelineText->bind();
-	_pipelineText->setMat4("projection", _projectionText);
-	_pipelineText->setInt("text", 0);
+	_pipelineText->setMat4("projection"_sid, _projectionText);
+	_pipelineText->setInt("text"_sid, 0);
+
+	_evictionCallback = Resources::Manager().addEvictionCallback([this](AssetClass assetClass, StringId id) {
+		if (assetClass != AssetClass::Textures) return;
+		std::unique_lock<std::mutex> lock(_resourceEventsMutex);
+		_evictedTextures.push_back(id);
+	});
+	_changeCallback = Resources::Manager().addChangeCallback([this](const std::string& path) {
+		std::unique_lock<std::mutex> lock(_resourceEventsMutex);
+		_changedResources.push_back(path);
+	});
+	if (_config.hotReload && !Resources::Manager().watch())
+	{
+		Log::Warning(LogCategory::Renderer, "Hot reloading is unavailable");
+	}
 }
 
 Renderer::~Renderer()
 {
+	Resources::Manager().removeEvictionCallback(_evictionCallback);
+	Resources::Manager().removeChangeCallback(_changeCallback);
+	for (auto & texture : _sharedTextures) texture.second.texture.release();
+
 	delete _pipeline;
 	glDeleteVertexArrays(1, &_VAO);
 	glDeleteBuffers(1, &_VBO);
@@ -113,6 +135,14 @@ Renderer::~Renderer()
 void Renderer::newFrame()
 {
 	glfwSwapBuffers(_window);
+
+	_currentFrame = (_currentFrame + 1) % _MaxFramesInFlight;
+	_frameAllocator.beginFrame(_currentFrame);
+	Scratch::NextFrame();
+
+	releaseEvictedTextures();
+	reloadChangedResources();
+	uploadPendingTextures();
 }
 
 void Renderer::clear(vec3 color)
@@ -123,37 +153,170 @@ void Renderer::clear(vec3 color)
 
 void Renderer::loadTexture(const char* texture)
 {
-	_textures[texture].load(Resources::Manager().getTexture(texture));
+	upload(texture, Resources::Manager().getTexture(texture));
+}
+
+Texture &Renderer::upload(StringId id, const ddls::Texture& texture)
+{
+	unbind(id);
+
+	auto [shared, inserted] = _sharedTextures.tryEmplace(texture.contentHash);
+	if (inserted) shared->texture.load(texture);
+	shared->aliases++;
+	_textures[id] = texture.contentHash;
+
+	return shared->texture;
+}
+
+void Renderer::unbind(StringId id)
+{
+	u64 *contentHash = _textures.find(id);
+	if (!contentHash) return;
+
+	SharedTexture *shared = _sharedTextures.find(*contentHash);
+	if (!--shared->aliases)
+	{
+		shared->texture.release();
+		_sharedTextures.erase(*contentHash);
+	}
+	_textures.erase(id);
+}
+
+void Renderer::loadTextureAsync(const char* texture)
+{
+	StringId id(texture);
+	if (_textures.contains(id) || _pendingTextures.contains(id)) return;
+
+	_pendingTextures.tryEmplace(id, Resources::Manager().loadTextureAsync(texture));
+}
+
+void Renderer::uploadPendingTextures()
+{
+	// Entries can't be erased while iterating, the finished ones are collected first
+	StringId finished[_MaxUploadsPerFrame];
+	u32 finishedCount = 0;
+	for (auto & pending : _pendingTextures)
+	{
+		if (finishedCount == _MaxUploadsPerFrame) break;
+
+		LoadState state = pending.second.state();
+		if (state == LoadState::Pending) continue;
+		if (state == LoadState::Ready) upload(pending.first, pending.second.get());
+		finished[finishedCount++] = pending.first;
+	}
+
+	for (u32 i = 0; i < finishedCount; i++) _pendingTextures.erase(finished[i]);
+}
+
+void Renderer::releaseEvictedTextures()
+{
+	std::unique_lock<std::mutex> lock(_resourceEventsMutex);
+	for (StringId id : _evictedTextures)
+	{
+		// The next draw loads it again
+		unbind(id);
+	}
+	_evictedTextures.clear();
+}
+
+void Renderer::reloadChangedResources()
+{
+	std::vector<std::string> changed;
+	{
+		std::unique_lock<std::mutex> lock(_resourceEventsMutex);
+		changed.swap(_changedResources);
+	}
+
+	for (const std::string& path : changed)
+	{
+		StringId id(path);
+		if (_pipeline->uses(id)) _pipeline->reload();
+		if (_pipelineText->uses(id) && _pipelineText->reload())
+		{
+			_pipelineText->bind();
+			_pipelineText->setMat4("projection"_sid, _projectionText);
+			_pipelineText->setInt("text"_sid, 0);
+		}
+
+		// Its new contents may now be shared with another path, or no longer be
+		if (_textures.contains(id)) upload(id, Resources::Manager().getTexture(path.c_str()));
+	}
 }
 
 void Renderer::drawTexture(const char* texture, mat4 model)
 {
-	if (!_textures.count(texture)) loadTexture(texture);
+	StringId id(texture);
+	Texture *loaded;
+	if (u64 *contentHash = _textures.find(id))
+	{
+		loaded = &_sharedTextures.find(*contentHash)->texture;
+	}
+	else
+	{
+		// Still streaming in, skip it rather than stall the frame
+		if (_pendingTextures.contains(id)) return;
+		loaded = &upload(id, Resources::Manager().getTexture(texture));
+	}
 
 	glActiveTexture(GL_TEXTURE0);
-	_pipeline->setInt("tex", 0);
-	_textures[texture].bind();
+	_pipeline->setInt("tex"_sid, 0);
+	loaded->bind();
 
 	_pipeline->bind();
-	_pipeline->setMat4("model", model);
-	_pipeline->setMat4("view", camera.view());
-	_pipeline->setMat4("projection", _projection);
+	_pipeline->setMat4("model"_sid, model);
+	_pipeline->setMat4("view"_sid, camera.view());
+	_pipeline->setMat4("projection"_sid, _projection);
+
+	// Premultiplied textures carry their coverage, they are blended over what's drawn
+	if (loaded->premultiplied())
+	{
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	}
 
 	glBindVertexArray(_VAO);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+	if (loaded->premultiplied()) glDisable(GL_BLEND);
+}
+
+// FreeType allocates through the engine, so that fonts are accounted under their own tag
+static void* fontAllocate(FT_Memory memory, long size)
+{
+	ddls::ignore(memory);
+	return Memory::Allocate((MemSize)size, MemoryTag::Fonts);
+}
+
+static void fontFree(FT_Memory memory, void* block)
+{
+	ddls::ignore(memory);
+	Memory::Free(block);
 }
 
+static void* fontReallocate(FT_Memory memory, long currentSize, long newSize, void* block)
+{
+	ddls::ignore(memory);
+	void* reallocated = Memory::Allocate((MemSize)newSize, MemoryTag::Fonts);
+	if (!reallocated) return nullptr;
+	if (block) std::memcpy(reallocated, block, (size_t)std::min(currentSize, newSize));
+	Memory::Free(block);
+	return reallocated;
+}
+
+static FT_MemoryRec_ fontMemory{nullptr, fontAllocate, fontFree, fontReallocate};
+
 void Renderer::loadFont(const char* fontName)
 {
 	FT_Library ft;
-	FT_Init_FreeType(&ft);
+	FT_New_Library(&fontMemory, &ft);
+	FT_Add_Default_Modules(ft);
 
 	FT_Face face;
 	std::filesystem::path path = Resources::Manager().getPath(fontName);
 	if(FT_New_Face(ft, path.c_str(), 0, &face))
 	{
-		Log::Error("Failed to load font at ", path);
+		Log::Error(LogCategory::Renderer, "Failed to load font at ", path);
 	}
 
 	// set size to load glyphs as
@@ -168,7 +331,7 @@ void Renderer::loadFont(const char* fontName)
 		// Load character glyph 
 		if (FT_Load_Char(face, c, FT_LOAD_RENDER))
 		{
-			Log::Error("Failed to load Glyph");
+			Log::Error(LogCategory::Renderer, "Failed to load Glyph");
 			continue;
 		}
 		// generate texture
@@ -203,52 +366,75 @@ void Renderer::loadFont(const char* fontName)
 	glBindTexture(GL_TEXTURE_2D, 0);
 
 	FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+	FT_Done_Library(ft);
 }
 
 void Renderer::drawText(std::string text, vec2 position, float scale, vec3 color)
 {
+	// build the glyph quads in frame memory, a batch at a time so the VBO is updated once per batch
+	u32 count = (u32)text.size();
+	if (!count) return;
+	u32 batch = std::min(count, _TextBatchGlyphs);
+	u64 vertexSize = 6 * batch * sizeof(vec4);
+	Expected<Ptr, AllocError> batchMemory = _frameAllocator.tryAllocate(vertexSize + batch * sizeof(u32), alignof(vec4), false);
+	// frame memory can run out with a lot of text, the heap is slower but the text is still drawn
+	Ptr heapMemory = batchMemory ? nullptr : Memory::Allocate(vertexSize + batch * sizeof(u32), MemoryTag::Renderer);
+	Ptr memory = batchMemory ? batchMemory.value() : heapMemory;
+	if (!memory)
+	{
+		DDLS_LOG_EVERY(Error, 1, LogCategory::Renderer, "Not enough memory to draw text!");
+		return;
+	}
+
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	_pipelineText->bind();
-	_pipelineText->setVec3("textColor", color);
+	_pipelineText->setVec3("textColor"_sid, color);
 	glActiveTexture(GL_TEXTURE0);
 	glBindVertexArray(_VAOText);
 
-	// iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++) 
-    {
-        Character ch = _characters[*c];
-
-        float xpos = position.x + ch.bearing.x * scale;
-        float ypos = position.y - (ch.size.y - ch.bearing.y) * scale;
-
-        float w = ch.size.x * scale;
-        float h = ch.size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },            
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }           
-        };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.texId);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, _VBOText);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        position.x += (ch.advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
-    }
+	vec4 *vertices = (vec4 *)memory;
+	u32 *textures = (u32 *)((u8 *)memory + vertexSize);
+	for (u32 first = 0; first < count; first += batch)
+	{
+		u32 glyphs = std::min(batch, count - first);
+		for (u32 i = 0; i < glyphs; i++)
+		{
+			Character ch = _characters[text[first + i]];
+
+			float xpos = position.x + ch.bearing.x * scale;
+			float ypos = position.y - (ch.size.y - ch.bearing.y) * scale;
+
+			float w = ch.size.x * scale;
+			float h = ch.size.y * scale;
+
+			vec4 *quad = vertices + 6 * i;
+			quad[0] = { xpos,     ypos + h,   0.0f, 0.0f };
+			quad[1] = { xpos,     ypos,       0.0f, 1.0f };
+			quad[2] = { xpos + w, ypos,       1.0f, 1.0f };
+			quad[3] = { xpos,     ypos + h,   0.0f, 0.0f };
+			quad[4] = { xpos + w, ypos,       1.0f, 1.0f };
+			quad[5] = { xpos + w, ypos + h,   1.0f, 0.0f };
+			textures[i] = ch.texId;
+
+			// now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+			position.x += (ch.advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
+		}
+
+		// orphan the previous storage and upload the whole batch
+		glBindBuffer(GL_ARRAY_BUFFER, _VBOText);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(6 * glyphs * sizeof(vec4)), vertices, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		// render each glyph texture over its quad
+		for (u32 i = 0; i < glyphs; i++)
+		{
+			glBindTexture(GL_TEXTURE_2D, textures[i]);
+			glDrawArrays(GL_TRIANGLES, (GLint)(6 * i), 6);
+		}
+	}
+	if (heapMemory) Memory::Free(heapMemory);
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
 
@@ -263,7 +449,7 @@ void Renderer::viewportUpdate(u16 width, u16 height)
 	glViewport(0, 0, width, height);
 	_projectionText = ortho(0.0f, (f32)width, 0.0f, (f32)height);
 	_pipelineText->bind();
-	_pipelineText->setMat4("projection", _projectionText);
+	_pipelineText->setMat4("projection"_sid, _projectionText);
 }
 
 static void resizeCallback(GLFWwindow *window, i32 width, i32 height)
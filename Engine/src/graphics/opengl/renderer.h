@@ -1,10 +1,17 @@
 #pragma once
 
 #include "graphics/renderer.h"
+#include "core/hash_map.h"
+#include "core/string_id.h"
+#include "memory/frame_allocator.h"
+#include "memory/memory_resource.h"
 
 #include "graphics/opengl/pipeline.h"
 #include "graphics/opengl/texture.h"
 
+#include <mutex>
+#include <vector>
+
 namespace ddls::gl {
 
 struct Character
@@ -23,25 +30,59 @@ public:
 	void newFrame() override;
 	void clear(vec3 color) override;
 	void loadTexture(const char* texture) override;
+	void loadTextureAsync(const char* texture) override;
 	void drawTexture(const char* texture, mat4 model) override;
 	void loadFont(const char* fontName) override;
 	void drawText(std::string text, vec2 position, float scale, vec3 color) override;
 	void viewportUpdate(u16 width, u16 height) override;
 
 private:
+	// Map nodes all have the same size, they are served by a pool
+	PoolAllocator _nodePool{96, 128, true, DefaultAlignment, MemoryTag::Renderer};
+	PoolResource _nodeResource{_nodePool};
+
 	// Textures
 	Pipeline *_pipeline;
 	u32 _VAO{};
 	u32 _VBO{};
 	u32 _EBO{};
-	std::map<const char*, Texture> _textures;
+	// Paths with identical contents share one GPU texture, keyed on their content hash
+	struct SharedTexture
+	{
+		Texture texture;
+		u32 aliases = 0;
+	};
+	HashMap<StringId, u64> _textures{MemoryTag::Renderer};
+	HashMap<u64, SharedTexture> _sharedTextures{MemoryTag::Renderer};
+	Texture &upload(StringId id, const ddls::Texture& texture);
+	void unbind(StringId id);
+	// Decoded by the resource workers, uploaded a few per frame to bound the stall
+	HashMap<StringId, TextureHandle> _pendingTextures{MemoryTag::Renderer};
+	static constexpr u32 _MaxUploadsPerFrame = 4;
+	void uploadPendingTextures();
+	// Evicted from the resource cache or changed on disk, possibly reported by another
+	// thread, handled at the next frame
+	u32 _evictionCallback;
+	u32 _changeCallback;
+	std::mutex _resourceEventsMutex;
+	std::vector<StringId> _evictedTextures;
+	std::vector<std::string> _changedResources;
+	void releaseEvictedTextures();
+	void reloadChangedResources();
 
 	// Text
 	Pipeline *_pipelineText;
 	u32 _VAOText{};
 	u32 _VBOText{};
-	std::map<char, Character> _characters;
+	// Glyphs uploaded per draw batch, so that long strings don't need more frame memory
+	static constexpr u32 _TextBatchGlyphs = 128;
+	std::pmr::map<char, Character> _characters{&_nodeResource};
 	mat4 _projectionText;
+
+	// Transient CPU-side data, recycled every _MaxFramesInFlight frames
+	const u32 _MaxFramesInFlight = 2;
+	u32 _currentFrame{};
+	FrameAllocator _frameAllocator{_MaxFramesInFlight, 64 * 1024, MemoryTag::Renderer};
 };
 
 } // namespace ddls::gl
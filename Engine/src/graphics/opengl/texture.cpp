@@ -4,12 +4,21 @@
 
 namespace ddls::gl {
 
+// Indexed by channel count - 1
+static const GLenum Formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+// Grey and grey-alpha images are stored in the red and green channels
+static const GLint Swizzles[][4] = {
+    {GL_RED, GL_RED, GL_RED, GL_ONE},
+    {GL_RED, GL_RED, GL_RED, GL_GREEN},
+    {GL_RED, GL_GREEN, GL_BLUE, GL_ONE},
+    {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA}
+};
+
 Texture::Texture():
-    internalFormat(GL_RGB), 
-    imageFormat(GL_RGB), 
     wrapS(GL_REPEAT), 
     wrapT(GL_REPEAT),
     filterMin(GL_LINEAR),
+    filterMinMipmap(GL_LINEAR_MIPMAP_LINEAR),
     filterMax(GL_LINEAR)
 {
     glGenTextures(1, &_handle);
@@ -17,22 +26,47 @@ Texture::Texture():
 
 void Texture::load(ddls::Texture texture)
 {
+    // A texture that failed to load shows up as opaque magenta rather than reading past the tables
+    static const u8 Missing[] = {0xFF, 0x00, 0xFF, 0xFF};
+    if (!texture.data || texture.channels - 1u >= 4u || !texture.mipCount)
+    {
+        texture = ddls::Texture{};
+        texture.data = (unsigned char *) Missing;
+        texture.width = 1;
+        texture.height = 1;
+        texture.channels = 4;
+    }
+
+    GLenum format = Formats[texture.channels - 1];
+    _premultiplied = texture.premultiplied;
+
+    // Decoded rows are tightly packed, cooked ones padded to their alignment
+    i32 unpackAlignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, texture.rowAlignment);
+
     glBindTexture(GL_TEXTURE_2D, _handle);
-    glTexImage2D(
-        GL_TEXTURE_2D, 
-        0, 
-        internalFormat, 
-        texture.width, 
-        texture.height,
-        0,
-        imageFormat,
-        GL_UNSIGNED_BYTE,
-        texture.data
-    );
+    for (u16 level = 0; level < texture.mipCount; level++)
+    {
+        glTexImage2D(
+            GL_TEXTURE_2D, 
+            level, 
+            (i32)format, 
+            texture.mipWidth(level), 
+            texture.mipHeight(level),
+            0,
+            format,
+            GL_UNSIGNED_BYTE,
+            texture.mip(level)
+        );
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
 
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.mipCount - 1);
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, Swizzles[texture.channels - 1]);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filterMin);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.mipCount > 1 ? filterMinMipmap : filterMin);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterMax);
 
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -43,4 +77,10 @@ void Texture::bind() const
     glBindTexture(GL_TEXTURE_2D, _handle);
 }
 
+void Texture::release()
+{
+    glDeleteTextures(1, &_handle);
+    _handle = 0;
+}
+
 } // namespace ddls::gl
\ No newline at end of file
@@ -16,14 +16,20 @@ public:
     u32 handle() const { return _handle; }
 
     /**
-     * @brief Configurable variables
+     * @brief Whether the colors were multiplied by the alpha, to be blended accordingly
+     * 
+     */
+    b8 premultiplied() const { return _premultiplied; }
+
+    /**
+     * @brief Configurable variables, the format follows the loaded texture's channels
      * 
      */
-    i32 internalFormat;
-    u32 imageFormat;
     i32 wrapS;
     i32 wrapT;
     i32 filterMin;
+    // Minification filter of textures with levels
+    i32 filterMinMipmap;
     i32 filterMax;
 
     /**
@@ -33,7 +39,7 @@ public:
     Texture();
 
     /**
-     * @brief Load an engine's texture
+     * @brief Load an engine's texture, every level of a cooked one
      * 
      * @param texture The texture to load
      */
@@ -45,8 +51,15 @@ public:
      */
     void bind() const;
 
+    /**
+     * @brief Deletes the GPU copy of the texture
+     * 
+     */
+    void release();
+
 private:
     u32 _handle;
+    b8 _premultiplied = false;
 };
 
 } // namespace ddls::gl
\ No newline at end of file
@@ -32,6 +32,9 @@ struct DDLS_API RendererConfig
 	ProjectionType projectionType;
 	f32 planeNear;
 	f32 planeFar;
+
+	// Rebuilds the shaders and textures changed on disk, to iterate without restarting
+	b8 hotReload = false;
 };
 
 class DDLS_API Renderer
@@ -42,6 +45,8 @@ public:
 	virtual void newFrame() = 0;
 	virtual void clear(vec3 color) = 0;
 	virtual void loadTexture(const char* texture) = 0;
+	// Decodes in the background, the texture isn't drawn until it's uploaded by a later newFrame()
+	virtual void loadTextureAsync(const char* texture) = 0;
 	virtual void drawTexture(const char* texture, mat4 model) = 0;
 	virtual void loadFont(const char* fontName) = 0;
 	virtual void drawText(std::string text, vec2 position, float scale, vec3 color) = 0;
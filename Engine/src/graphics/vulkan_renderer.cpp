@@ -1,6 +1,8 @@
 #include "graphics/vulkan_renderer.h"
 
 #include "core/log.h"
+#include "memory/scratch.h"
+#include "memory/memory_resource.h"
 
 #include <backends/imgui_impl_vulkan.h>
 #include <backends/imgui_impl_glfw.h>
@@ -21,9 +23,18 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
         const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData,
         void *pUserData)
 {
-    ignore(messageSeverity, messageType, pUserData);
-
-    Log::Out(Log::Styles::Default, Log::Colours::LightBlue, "VALIDATION", pCallbackData->pMessage);
+    ignore(messageType, pUserData);
+
+    // Filtered like the engine's own messages, under the Vulkan category.
+    // The same message is often reported every frame, repeats are collapsed.
+    if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+        DDLS_LOG_DEDUP(Error, LogCategory::Vulkan, "Validation: ", pCallbackData->pMessage);
+    else if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+        DDLS_LOG_DEDUP(Warning, LogCategory::Vulkan, "Validation: ", pCallbackData->pMessage);
+    else if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT)
+        DDLS_LOG_DEDUP(Info, LogCategory::Vulkan, "Validation: ", pCallbackData->pMessage);
+    else
+        DDLS_LOG_DEDUP(Debug, LogCategory::Vulkan, "Validation: ", pCallbackData->pMessage);
 
     return VK_FALSE;
 }
@@ -98,13 +109,17 @@ VulkanRenderer::VulkanRenderer(
     Assert(glfwCreateWindowSurface(_instance, window, nullptr, &_surface) == VK_SUCCESS,
            "Failed to create window surface!");
 
+    // Enumeration results only live for the duration of the constructor
+    Scratch::Scope scratchScope;
+    ArenaResource scratch(scratchScope.arena());
+
     uint32_t deviceCount = 0;
     vkEnumeratePhysicalDevices(_instance, &deviceCount, nullptr);
 
     Assert(deviceCount,
            "No physical device was found!");
 
-    std::vector<VkPhysicalDevice> physicalDevices(deviceCount);
+    std::pmr::vector<VkPhysicalDevice> physicalDevices(deviceCount, &scratch);
     vkEnumeratePhysicalDevices(_instance, &deviceCount, physicalDevices.data());
 
     // Find a suitable physical device
@@ -123,15 +138,15 @@ VulkanRenderer::VulkanRenderer(
     VkPhysicalDeviceProperties physicalDeviceProperties;
     vkGetPhysicalDeviceProperties(_physicalDevice, &physicalDeviceProperties);
 
-    Log::Info("Picking physical device ", physicalDeviceProperties.deviceName);
+    Log::Info(LogCategory::Vulkan, "Picking physical device ", physicalDeviceProperties.deviceName);
 
     u32 extensionCount = 0;
     vkEnumerateDeviceExtensionProperties(_physicalDevice, nullptr, &extensionCount, nullptr);
-    std::vector<VkExtensionProperties> extensions(extensionCount);
+    std::pmr::vector<VkExtensionProperties> extensions(extensionCount, &scratch);
     vkEnumerateDeviceExtensionProperties(_physicalDevice, nullptr, &extensionCount, extensions.data());
-    Log::Info("Device extensions");
+    Log::Info(LogCategory::Vulkan, "Device extensions");
     for (const auto &extension: extensions)
-        Log::Info('\t', extension.extensionName);
+        Log::Info(LogCategory::Vulkan, '\t', extension.extensionName);
 
     QueueFamilyIndices indices = findQueueFamilies(_physicalDevice);
 
@@ -614,6 +629,9 @@ void VulkanRenderer::render(ImDrawData *drawData)
 {
     vkWaitForFences(_device, 1, &_inFlightFences[_currentFrame], VK_TRUE, (u64) -1);
 
+    _frameAllocator.beginFrame(_currentFrame);
+    Scratch::NextFrame();
+
     uint32_t imageIndex;
     VkResult result = vkAcquireNextImageKHR(_device, _swapchain, (u64) -1, _imageAvailableSemaphores[_currentFrame],
                                             VK_NULL_HANDLE, &imageIndex);
@@ -855,22 +873,28 @@ std::vector<const char *> VulkanRenderer::getRequiredExtensions(
 
 void VulkanRenderer::enumerateAvailableExtensions()
 {
+    Scratch::Scope scratchScope;
+    ArenaResource scratch(scratchScope.arena());
+
     u32 extensionCount = 0;
     vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
-    std::vector<VkExtensionProperties> extensions(extensionCount);
+    std::pmr::vector<VkExtensionProperties> extensions(extensionCount, &scratch);
     vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
-    Log::Info("Available extensions");
+    Log::Info(LogCategory::Vulkan, "Available extensions");
     for (const auto &extension: extensions)
-        Log::Info('\t', extension.extensionName);
+        Log::Info(LogCategory::Vulkan, '\t', extension.extensionName);
 }
 
 bool VulkanRenderer::checkValidationLayerSupport(
         std::vector<const char *> validationLayers)
 {
+    Scratch::Scope scratchScope;
+    ArenaResource scratch(scratchScope.arena());
+
     u32 layerCount;
     vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
 
-    std::vector<VkLayerProperties> availableLayers(layerCount);
+    std::pmr::vector<VkLayerProperties> availableLayers(layerCount, &scratch);
     vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
 
     for (const char *layerName: validationLayers)
@@ -914,7 +938,7 @@ bool VulkanRenderer::isDeviceSuitable(
 {
     VkPhysicalDeviceProperties physicalDeviceProperties;
     vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
-    Log::Info("Checking if device ", physicalDeviceProperties.deviceName, " is suitable");
+    Log::Info(LogCategory::Vulkan, "Checking if device ", physicalDeviceProperties.deviceName, " is suitable");
     VkPhysicalDeviceFeatures deviceFeatures;
     vkGetPhysicalDeviceFeatures(physicalDevice, &deviceFeatures);
 
@@ -935,10 +959,13 @@ bool VulkanRenderer::isDeviceSuitable(
 VulkanRenderer::QueueFamilyIndices VulkanRenderer::findQueueFamilies(
         VkPhysicalDevice physicalDevice)
 {
+    Scratch::Scope scratchScope;
+    ArenaResource scratch(scratchScope.arena());
+
     uint32_t queueFamilyCount = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
 
-    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    std::pmr::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount, &scratch);
     vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
 
     // Finding a queue that supports graphics commands
@@ -968,13 +995,16 @@ VulkanRenderer::QueueFamilyIndices VulkanRenderer::findQueueFamilies(
 bool VulkanRenderer::checkDeviceExtensionSupport(
         VkPhysicalDevice physicalDevice)
 {
+    Scratch::Scope scratchScope;
+    ArenaResource scratch(scratchScope.arena());
+
     u32 extensionCount;
     vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
 
-    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    std::pmr::vector<VkExtensionProperties> availableExtensions(extensionCount, &scratch);
     vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
 
-    std::set<std::string> requiredExtensions(_deviceExtensions.begin(), _deviceExtensions.end());
+    std::pmr::set<std::string_view> requiredExtensions(_deviceExtensions.begin(), _deviceExtensions.end(), &scratch);
 
     for (const auto &extension: availableExtensions)
     {
@@ -1164,7 +1194,7 @@ void VulkanRenderer::updateUniformBuffer(u32 currentFrame)
     auto currentTime = std::chrono::high_resolution_clock::now();
     float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
-    UniformBufferObject ubo{};
+    UniformBufferObject &ubo = *_frameAllocator.allocateArray<UniformBufferObject>(1);
     ubo.model = glm::rotate(glm::mat4(1.0f), rotate, glm::vec3(0.0, 1.0, 0.0));
     ubo.model = glm::rotate(ubo.model, time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
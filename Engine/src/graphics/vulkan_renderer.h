@@ -2,6 +2,7 @@
 
 #include <core/defines.h>
 #include <core/types.h>
+#include <memory/frame_allocator.h>
 
 #define GLFW_INCLUDE_VULKAN
 
@@ -111,6 +112,8 @@ private:
     std::vector<VkFence> _inFlightFences;
     const u32 _MaxFramesInFlight = 2;
     u32 _currentFrame;
+    // Transient CPU-side data, recycled once the frame's fence signals
+    FrameAllocator _frameAllocator{_MaxFramesInFlight, 64 * 1024, MemoryTag::Renderer};
     b8 _framebufferResized;
 
     struct Vertex
@@ -0,0 +1,132 @@
+#include "memory/allocation_tracker.h"
+
+#include "core/log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+namespace ddls {
+
+static Boolean intact(const u8 *guard)
+{
+    for (MemSize i = 0; i < GuardSize; i++)
+        if (guard[i] != GuardByte) return false;
+    return true;
+}
+
+AllocationTracker::~AllocationTracker()
+{
+    std::free(_records);
+}
+
+Boolean AllocationTracker::reserve(u64 count) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<Record>, "Tracker records are moved with memmove");
+
+    if (count <= _capacity) return true;
+    Record *records = (Record *) std::realloc(_records, count * sizeof(Record));
+    if (!records) return false;
+    _records = records;
+    _capacity = count;
+    return true;
+}
+
+Boolean AllocationTracker::add(u8 *allocation, MemSize size, const std::source_location &site) noexcept
+{
+    if (_count == _capacity && !reserve(std::max<u64>(16, 2 * _capacity))) return false;
+
+    memset(allocation - GuardSize, GuardByte, GuardSize);
+    memset(allocation + size, GuardByte, GuardSize);
+
+    // Linear allocators always add above every live allocation, the common case is an append
+    Record *at = _count && _records[_count - 1].allocation > allocation ? lowerBound(allocation) : _records + _count;
+    memmove(at + 1, at, (u64) (_records + _count - at) * sizeof(Record));
+    *at = Record{allocation, size, site};
+    _count++;
+    return true;
+}
+
+Boolean AllocationTracker::remove(u8 *allocation, const std::source_location &site)
+{
+    Record *record = lowerBound(allocation);
+    if (record == _records + _count || record->allocation != allocation)
+    {
+        Log::Error(_owner, ": freeing ", (void *) allocation, " which isn't a live allocation, from ",
+            site.file_name(), ":", site.line());
+        return false;
+    }
+
+    checkGuards(*record);
+    memmove(record, record + 1, (u64) (_records + _count - record - 1) * sizeof(Record));
+    _count--;
+    return true;
+}
+
+void AllocationTracker::removeFrom(u8 *address) noexcept
+{
+    Record *first = lowerBound(address);
+    for (Record *record = first; record != _records + _count; record++)
+    {
+        Boolean front = intact(record->allocation - GuardSize);
+        if (front && intact(record->allocation + record->size)) continue;
+        if (_damagedCount < MaxDamaged) _damaged[_damagedCount] = Damage{*record, front};
+        _damagedCount++;
+    }
+    _count = (u64) (first - _records);
+}
+
+u64 AllocationTracker::reportDamaged()
+{
+    u64 damaged = _damagedCount;
+    // Cleared first, so that a report failing halfway isn't repeated
+    _damagedCount = 0;
+    for (u64 i = 0; i < std::min(damaged, MaxDamaged); i++) reportDamage(_damaged[i].record, _damaged[i].front);
+    if (damaged > MaxDamaged) Log::Error(_owner, ": ", damaged - MaxDamaged, " more damaged allocations were freed");
+    return damaged;
+}
+
+u64 AllocationTracker::check() const
+{
+    u64 overruns = 0;
+    for (u64 i = 0; i < _count; i++)
+        if (!checkGuards(_records[i])) overruns++;
+    return overruns;
+}
+
+u64 AllocationTracker::reportLeaks() const
+{
+    for (u64 i = 0; i < _count; i++)
+    {
+        const Record &record = _records[i];
+        Log::Warning(_owner, ": leaked ", record.size, " bytes at ", (void *) record.allocation, " allocated from ",
+            record.site.file_name(), ":", record.site.line(), " in ", record.site.function_name());
+    }
+    return _count;
+}
+
+AllocationTracker::Record *AllocationTracker::lowerBound(u8 *address) const
+{
+    return std::lower_bound(_records, _records + _count, address,
+        [](const Record &record, u8 *value) { return record.allocation < value; });
+}
+
+Boolean AllocationTracker::checkGuards(const Record &record) const
+{
+    Boolean front = intact(record.allocation - GuardSize);
+    Boolean back = intact(record.allocation + record.size);
+    if (front && back) return true;
+
+    reportDamage(record, front);
+    return false;
+}
+
+void AllocationTracker::reportDamage(const Record &record, Boolean front) const
+{
+    Log::Error(_owner, ": ", front ? "overrun after " : "underrun before ", record.size, " bytes at ",
+        (void *) record.allocation, " allocated from ", record.site.file_name(), ":", record.site.line(),
+        " in ", record.site.function_name());
+}
+
+} // namespace ddls
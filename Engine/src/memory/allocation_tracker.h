@@ -0,0 +1,131 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/error.h"
+#include "core/memory.h"
+
+#include <source_location>
+
+namespace ddls {
+
+/**
+ * @brief Bytes placed before and after every allocation to detect overruns, only in debug builds
+ * 
+ */
+#ifdef DDLS_DEBUG
+static constexpr MemSize GuardSize = 16;
+#else
+static constexpr MemSize GuardSize = 0;
+#endif
+
+static constexpr u8 GuardByte = 0xFD;
+
+/**
+ * @brief Records live allocations of an allocator with their call site and checks their guard bytes
+ * 
+ * Allocators only hold one in debug builds, and are responsible for leaving GuardSize bytes
+ * on each side of an allocation. Problems are reported through Log.
+ * 
+ * Records are kept sorted by address in an array of their own, allocated from the C heap
+ * so that the heap tracker doesn't recurse. Recording never throws, so that noexcept
+ * allocation paths can use it.
+ * 
+ */
+class DDLS_API AllocationTracker
+{
+public:
+    /**
+     * @param owner A static name for the owning allocator, used in reports
+     */
+    explicit AllocationTracker(const char *owner) : _owner(owner) {}
+
+    ~AllocationTracker();
+
+    AllocationTracker(AllocationTracker const&) = delete;
+    void operator=(AllocationTracker const&)    = delete;
+
+    /**
+     * @brief Makes room for count records, so that adding up to that many never fails
+     * 
+     * @return false if the memory for them couldn't be allocated
+     */
+    Boolean reserve(u64 count) noexcept;
+
+    /**
+     * @brief Writes the guards around an allocation and records it
+     * 
+     * @return false if there was no room for the record and it couldn't be made
+     */
+    Boolean add(u8 *allocation, MemSize size, const std::source_location &site) noexcept;
+
+    /**
+     * @brief Checks the guards of an allocation and forgets it
+     * 
+     * @return false if the allocation is unknown, a double or invalid free
+     */
+    Boolean remove(u8 *allocation, const std::source_location &site);
+
+    /**
+     * @brief Checks and forgets every allocation at or above the given address, for linear allocators
+     * 
+     * Damaged allocations are kept for reportDamaged() rather than logged, as logging may throw.
+     * 
+     */
+    void removeFrom(u8 *address) noexcept;
+
+    /**
+     * @brief Logs the damaged allocations removeFrom() found since the last report
+     * 
+     * @return The number of them
+     */
+    u64 reportDamaged();
+
+    /**
+     * @brief Checks the guards of every live allocation
+     * 
+     * @return The number of overruns found
+     */
+    u64 check() const;
+
+    /**
+     * @brief Logs every live allocation with its call site
+     * 
+     * @return The number of leaked allocations
+     */
+    u64 reportLeaks() const;
+
+    u64 count() const { return _count; }
+
+private:
+    struct Record
+    {
+        u8 *allocation;
+        MemSize size;
+        std::source_location site;
+    };
+
+    // The first record at or above the address
+    Record *lowerBound(u8 *address) const;
+
+    // A freed allocation with broken guards, reported without reading its memory again
+    struct Damage
+    {
+        Record record;
+        Boolean front;
+    };
+
+    Boolean checkGuards(const Record &record) const;
+    void reportDamage(const Record &record, Boolean front) const;
+
+    // The most damaged allocations kept between reports, any others are only counted
+    static constexpr u64 MaxDamaged = 8;
+
+    const char *_owner;
+    Record *_records = nullptr;
+    u64 _count = 0;
+    u64 _capacity = 0;
+    Damage _damaged[MaxDamaged];
+    u64 _damagedCount = 0;
+};
+
+} // namespace ddls
@@ -0,0 +1,27 @@
+#include "memory/frame_allocator.h"
+
+#include "core/assert.h"
+
+namespace ddls {
+
+FrameAllocator::FrameAllocator(u32 framesInFlight, MemSize frameSize, MemoryTag tag) :
+    _currentFrame(0)
+{
+    Assert(framesInFlight > 0,
+        "A frame allocator needs at least one frame!");
+
+    _frames.reserve(framesInFlight);
+    for (u32 i = 0; i < framesInFlight; i++)
+        _frames.push_back(std::make_unique<StackAllocator>(frameSize, tag));
+}
+
+void FrameAllocator::beginFrame(u32 frameIndex)
+{
+    Assert(frameIndex < _frames.size(),
+        fmt::format("Frame index {} is out of range!", frameIndex));
+
+    _currentFrame = frameIndex;
+    _frames[_currentFrame]->clear();
+}
+
+} // namespace ddls
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/memory.h"
+#include "memory/stack_allocator.h"
+
+#include <memory>
+#include <vector>
+
+namespace ddls {
+
+/**
+ * @brief A set of linear allocators, one per frame in flight, for transient per-frame data
+ *
+ * Memory allocated during a frame stays valid until the same frame index begins again,
+ * which happens once the GPU signalled it is done with it.
+ *
+ */
+class DDLS_API FrameAllocator
+{
+public:
+    /**
+     * @brief Allocates one stack per frame in flight
+     * 
+     * @param framesInFlight The number of frames the GPU may be working on at once
+     * @param frameSize The size of each frame's memory region in bytes
+     * @param tag The memory tag the regions are accounted under
+     */
+    FrameAllocator(u32 framesInFlight, MemSize frameSize = MemSize_default, MemoryTag tag = MemoryTag::Miscellaneous);
+
+    FrameAllocator(FrameAllocator const&) = delete;
+    void operator=(FrameAllocator const&) = delete;
+
+    /**
+     * @brief Makes the given frame current and frees everything it held
+     * 
+     * Must only be called once the frame's fence has signalled.
+     * 
+     * @param frameIndex The index of the frame, in [0, framesInFlight)
+     */
+    void beginFrame(u32 frameIndex);
+
+    /**
+     * @brief Allocates memory living until the current frame index comes back
+     * 
+     */
+    Ptr allocate(MemSize size, Boolean clear = true, const std::source_location &site = std::source_location::current())
+    {
+        return current().allocate(size, clear, site);
+    }
+
+    Ptr allocateAligned(MemSize size, MemSize alignment, Boolean clear = true,
+        const std::source_location &site = std::source_location::current())
+    {
+        return current().allocateAligned(size, alignment, clear, site);
+    }
+
+    template<typename T>
+    T *allocateArray(MemSize count, Boolean clear = true, const std::source_location &site = std::source_location::current())
+    {
+        return current().allocateArray<T>(count, clear, site);
+    }
+
+    Expected<Ptr, AllocError> tryAllocate(MemSize size, MemSize alignment = DefaultAlignment, Boolean clear = true,
+        const std::source_location &site = std::source_location::current()) noexcept
+    {
+        return current().tryAllocate(size, alignment, clear, site);
+    }
+
+    /**
+     * @brief The stack of the current frame
+     * 
+     */
+    StackAllocator &current() { return *_frames[_currentFrame]; }
+
+    u32 currentFrame() const { return _currentFrame; }
+
+    u32 framesInFlight() const { return (u32) _frames.size(); }
+
+private:
+    std::vector<std::unique_ptr<StackAllocator>> _frames;
+    u32 _currentFrame;
+};
+
+} // namespace ddls
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "core/memory.h"
+
+namespace ddls {
+
+/**
+ * @brief Rolls a linear allocator back to the position it had on construction
+ * 
+ * @tparam Allocator Any allocator exposing getMarker() and freeToMarker()
+ */
+template<typename Allocator>
+class MarkerScope
+{
+public:
+    explicit MarkerScope(Allocator &allocator) :
+        _allocator(allocator), _marker(allocator.getMarker()) {}
+
+    ~MarkerScope() { _allocator.freeToMarker(_marker); }
+
+    MarkerScope(MarkerScope const&)       = delete;
+    void operator=(MarkerScope const&)    = delete;
+
+private:
+    Allocator &_allocator;
+    Marker _marker;
+};
+
+} // namespace ddls
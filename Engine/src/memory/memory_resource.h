@@ -0,0 +1,95 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/memory.h"
+#include "memory/stack_allocator.h"
+#include "memory/frame_allocator.h"
+#include "memory/virtual_arena.h"
+#include "memory/pool_allocator.h"
+
+#include <memory_resource>
+
+namespace ddls {
+
+/**
+ * @brief Exposes a linear allocator as a std::pmr::memory_resource
+ * 
+ * Deallocation is a no-op, memory is reclaimed when the allocator is rolled back,
+ * like a std::pmr::monotonic_buffer_resource.
+ * 
+ * @tparam Allocator StackAllocator, FrameAllocator or VirtualArena
+ */
+template<typename Allocator>
+class LinearResource : public std::pmr::memory_resource
+{
+public:
+    explicit LinearResource(Allocator &allocator) : _allocator(allocator) {}
+
+    Allocator &allocator() { return _allocator; }
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        return _allocator.allocateAligned((MemSize) bytes, (MemSize) alignment, false);
+    }
+
+    void do_deallocate(void *pointer, size_t bytes, size_t alignment) override
+    {
+        ignore(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    Allocator &_allocator;
+};
+
+using StackResource = LinearResource<StackAllocator>;
+using FrameResource = LinearResource<FrameAllocator>;
+using ArenaResource = LinearResource<VirtualArena>;
+
+/**
+ * @brief Exposes a pool allocator as a std::pmr::memory_resource
+ * 
+ * Requests fitting in a block are served by the pool, node-based containers only ever make those,
+ * larger ones go to the upstream resource.
+ * 
+ */
+class PoolResource : public std::pmr::memory_resource
+{
+public:
+    explicit PoolResource(PoolAllocator &pool, std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) :
+        _pool(pool), _upstream(upstream) {}
+
+    PoolAllocator &pool() { return _pool; }
+
+private:
+    bool fits(size_t bytes, size_t alignment) const
+    {
+        return bytes <= _pool.blockSize() && alignment <= _pool.alignment();
+    }
+
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        if (fits(bytes, alignment)) return _pool.allocate();
+        return _upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *pointer, size_t bytes, size_t alignment) override
+    {
+        if (fits(bytes, alignment)) _pool.free(pointer);
+        else _upstream->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    PoolAllocator &_pool;
+    std::pmr::memory_resource *_upstream;
+};
+
+} // namespace ddls
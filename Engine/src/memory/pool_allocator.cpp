@@ -0,0 +1,126 @@
+#include "memory/pool_allocator.h"
+
+#include "core/assert.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace ddls {
+
+#ifdef DDLS_DEBUG
+// Patterns making use of uninitialized or freed blocks stand out in a debugger
+static constexpr u8 PoisonAllocated = 0xCD;
+static constexpr u8 PoisonFreed = 0xDD;
+#endif
+
+PoolAllocator::PoolAllocator(MemSize blockSize, MemSize blockCount, Boolean growable, MemSize alignment, MemoryTag tag) :
+    _freeList(nullptr),
+    _blockCount(blockCount),
+    _alignment(std::max(alignment, (MemSize) alignof(FreeBlock))),
+    _used(0),
+    _growable(growable),
+    _tag(tag)
+{
+    Assert(isPowerOfTwo(alignment),
+        fmt::format("Alignment {} is not a power of two!", alignment));
+    Assert(blockCount > 0,
+        "A pool needs at least one block per chunk!");
+
+    // Every block must be able to hold a free list link and keep the next one aligned
+    _blockSize = (MemSize) alignForward(std::max(blockSize, (MemSize) sizeof(FreeBlock)), _alignment);
+    _offset = (MemSize) alignForward(GuardSize, _alignment);
+    _stride = _offset + (MemSize) alignForward(_blockSize + GuardSize, _alignment);
+    _header = (MemSize) alignForward(sizeof(Chunk), _alignment);
+
+    if (!addChunk()) DDLS_THROW(OutOfMemoryException("Failed to allocate pool chunk!"));
+}
+
+PoolAllocator::~PoolAllocator()
+{
+#ifdef DDLS_DEBUG
+    _tracker.check();
+    _tracker.reportLeaks();
+#endif
+    while (_chunks)
+    {
+        Chunk *next = _chunks->next;
+        ::operator delete(_chunks, std::align_val_t(_alignment));
+        Memory::TrackFree(_tag, (u64) chunkSize());
+        _chunks = next;
+    }
+}
+
+Ptr PoolAllocator::allocate(const std::source_location &site)
+{
+    Expected<Ptr, AllocError> block = tryAllocate(site);
+    if (!block) DDLS_THROW(OutOfMemoryException("Pool is full!"));
+    return block.value();
+}
+
+Expected<Ptr, AllocError> PoolAllocator::tryAllocate(const std::source_location &site) noexcept
+{
+    if (!_freeList && !(_growable && addChunk())) return Unexpected(AllocError::OutOfMemory);
+
+    FreeBlock *block = _freeList;
+    _freeList = block->next;
+    _used++;
+
+    u8 *allocation = (u8 *) block + _offset;
+#ifdef DDLS_DEBUG
+    memset(block, PoisonAllocated, _stride);
+    // Room was reserved along with the chunk, so this can't fail
+    _tracker.add(allocation, _blockSize, site);
+#else
+    ignore(site);
+#endif
+    return (Ptr) allocation;
+}
+
+void PoolAllocator::free(Ptr pointer, const std::source_location &site)
+{
+    if (!pointer) return;
+
+#ifdef DDLS_DEBUG
+    // Pushing an unknown block would corrupt the free list, leave it be
+    if (!_tracker.remove((u8 *) pointer, site)) return;
+#else
+    ignore(site);
+#endif
+
+    FreeBlock *block = (FreeBlock *)((u8 *) pointer - _offset);
+#ifdef DDLS_DEBUG
+    memset(block, PoisonFreed, _stride);
+#endif
+    block->next = _freeList;
+    _freeList = block;
+    _used--;
+}
+
+Boolean PoolAllocator::addChunk() noexcept
+{
+#ifdef DDLS_DEBUG
+    // A record for every block, so that allocating never has to grow the tracker
+    if (!_tracker.reserve((_chunkCount + 1) * _blockCount)) return false;
+#endif
+    u8 *chunk = (u8 *) ::operator new((size_t) chunkSize(), std::align_val_t(_alignment), std::nothrow);
+    if (!chunk) return false;
+    _chunks = new (chunk) Chunk{_chunks};
+    _chunkCount++;
+    Memory::TrackAllocation(_tag, (u64) chunkSize());
+
+    // Thread the new blocks in address order in front of the free list
+    for (MemSize i = _blockCount; i-- > 0;)
+    {
+        FreeBlock *block = (FreeBlock *)(chunk + _header + (size_t) i * _stride);
+#ifdef DDLS_DEBUG
+        memset(block, PoisonFreed, _stride);
+#endif
+        block->next = _freeList;
+        _freeList = block;
+    }
+
+    return true;
+}
+
+} // namespace ddls
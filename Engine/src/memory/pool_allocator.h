@@ -0,0 +1,154 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/memory.h"
+#include "core/error.h"
+#include "core/expected.h"
+#include "memory/allocation_tracker.h"
+
+#include <new>
+#include <utility>
+
+namespace ddls {
+
+/**
+ * @brief An allocator of fixed-size blocks threaded on an intrusive free list
+ * 
+ */
+class DDLS_API PoolAllocator
+{
+public:
+    /**
+     * @brief Allocates a first chunk of blocks
+     * 
+     * @param blockSize The size of a block in bytes, at least a pointer
+     * @param blockCount The number of blocks in a chunk
+     * @param growable Whether a new chunk is allocated when the pool is full
+     * @param alignment The alignment of every block, a power of two
+     * @param tag The memory tag the chunks are accounted under
+     */
+    PoolAllocator(MemSize blockSize, MemSize blockCount, Boolean growable = false, MemSize alignment = DefaultAlignment,
+        MemoryTag tag = MemoryTag::Miscellaneous);
+
+    /**
+     * @brief Frees every chunk, blocks still in use included and reported as leaks in debug builds
+     * 
+     */
+    ~PoolAllocator();
+
+    PoolAllocator(PoolAllocator const&)  = delete;
+    void operator=(PoolAllocator const&) = delete;
+
+    /**
+     * @brief Pops a block from the free list
+     * 
+     * @return Ptr A pointer to the block
+     */
+    Ptr allocate(const std::source_location &site = std::source_location::current());
+
+    /**
+     * @brief Pops a block from the free list without throwing
+     * 
+     * @return A pointer to the block, or OutOfMemory if the pool is full and can't grow
+     */
+    Expected<Ptr, AllocError> tryAllocate(const std::source_location &site = std::source_location::current()) noexcept;
+
+    /**
+     * @brief Pushes a block back on the free list
+     * 
+     * @param pointer A block previously returned by allocate()
+     */
+    void free(Ptr pointer, const std::source_location &site = std::source_location::current());
+
+    /**
+     * @brief The usable size of a block in bytes, after alignment
+     * 
+     */
+    MemSize blockSize() const { return _blockSize; }
+
+    /**
+     * @brief The alignment of every block
+     * 
+     */
+    MemSize alignment() const { return _alignment; }
+
+    /**
+     * @brief The number of blocks in all chunks
+     * 
+     */
+    MemSize capacity() const { return _chunkCount * _blockCount; }
+
+    /**
+     * @brief The number of blocks currently handed out
+     * 
+     */
+    MemSize used() const { return _used; }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    // Heads every chunk, so that growing never allocates anything but the chunk itself
+    struct Chunk
+    {
+        Chunk *next;
+    };
+
+    Boolean addChunk() noexcept;
+
+    MemSize chunkSize() const { return _header + _stride * _blockCount; }
+
+    FreeBlock *_freeList;
+    Chunk *_chunks = nullptr;
+    MemSize _chunkCount = 0;
+    // Distance from a chunk to its first block
+    MemSize _header;
+    MemSize _blockSize;
+    // Distance between blocks, and from a block to the memory handed out, both grow with guards
+    MemSize _stride;
+    MemSize _offset;
+    MemSize _blockCount;
+    MemSize _alignment;
+    MemSize _used;
+    Boolean _growable;
+    MemoryTag _tag;
+#ifdef DDLS_DEBUG
+    AllocationTracker _tracker{"PoolAllocator"};
+#endif
+};
+
+/**
+ * @brief A typed pool constructing and destroying objects in place
+ * 
+ * @tparam T The type of the pooled objects
+ */
+template<typename T>
+class ObjectPool
+{
+public:
+    explicit ObjectPool(MemSize count, Boolean growable = true, MemoryTag tag = MemoryTag::Miscellaneous) :
+        _pool((MemSize) sizeof(T), count, growable, (MemSize) alignof(T), tag) {}
+
+    template<typename ... Args>
+    T *create(Args &&... args)
+    {
+        return new (_pool.allocate()) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T *object)
+    {
+        object->~T();
+        _pool.free(object);
+    }
+
+    MemSize used() const { return _pool.used(); }
+
+    MemSize capacity() const { return _pool.capacity(); }
+
+private:
+    PoolAllocator _pool;
+};
+
+} // namespace ddls
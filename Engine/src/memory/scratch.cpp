@@ -0,0 +1,128 @@
+#include "memory/scratch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace ddls {
+
+struct ScratchThread
+{
+    VirtualArena arena{Scratch::ReserveSize, MemoryTag::Scratch};
+    u64 frame;
+    // Scopes open on the owning thread, the arena is only reset when there are none
+    u32 scopes = 0;
+
+    // Published by the owning thread for Stats()
+    std::atomic<MemSize> committed{0};
+    std::atomic<MemSize> lastFrameUsed{0};
+    std::atomic<MemSize> peakFrameUsed{0};
+};
+
+struct ScratchRegistry
+{
+    std::mutex mutex;
+    std::vector<ScratchThread *> threads;
+    std::atomic<u64> frame{0};
+};
+
+// Never destroyed so that threads exiting during static destruction can still unregister
+static ScratchRegistry &registry()
+{
+    static ScratchRegistry *registry = new ScratchRegistry();
+    return *registry;
+}
+
+/**
+ * @brief Owns the calling thread's arena, unregistering it when the thread exits
+ * 
+ */
+struct ScratchThreadOwner
+{
+    ScratchThread *thread = nullptr;
+
+    ~ScratchThreadOwner()
+    {
+        if (!thread) return;
+        {
+            std::unique_lock<std::mutex> lock(registry().mutex);
+            auto &threads = registry().threads;
+            threads.erase(std::remove(threads.begin(), threads.end(), thread), threads.end());
+        }
+        delete thread;
+    }
+};
+
+ScratchThread &Scratch::Current()
+{
+    thread_local ScratchThreadOwner owner;
+    u64 frame = registry().frame.load(std::memory_order_acquire);
+
+    if (!owner.thread)
+    {
+        owner.thread = new ScratchThread();
+        owner.thread->frame = frame;
+        std::unique_lock<std::mutex> lock(registry().mutex);
+        registry().threads.push_back(owner.thread);
+    }
+
+    ScratchThread &thread = *owner.thread;
+    if (thread.frame != frame && !thread.scopes)
+    {
+        MemSize used = thread.arena.used();
+        thread.lastFrameUsed.store(used, std::memory_order_relaxed);
+        if (used > thread.peakFrameUsed.load(std::memory_order_relaxed))
+            thread.peakFrameUsed.store(used, std::memory_order_relaxed);
+
+        thread.arena.reset();
+        thread.frame = frame;
+    }
+    thread.committed.store(thread.arena.committed(), std::memory_order_relaxed);
+
+    return thread;
+}
+
+VirtualArena &Scratch::Arena()
+{
+    return Current().arena;
+}
+
+Scratch::Scope::Scope() : _thread(Current()), _marker(_thread.arena.getMarker())
+{
+    _thread.scopes++;
+}
+
+Scratch::Scope::~Scope()
+{
+    _thread.scopes--;
+    _thread.arena.freeToMarker(_marker);
+}
+
+VirtualArena &Scratch::Scope::arena()
+{
+    return _thread.arena;
+}
+
+void Scratch::NextFrame()
+{
+    registry().frame.fetch_add(1, std::memory_order_release);
+}
+
+ScratchStats Scratch::Stats()
+{
+    ScratchStats stats{};
+
+    std::unique_lock<std::mutex> lock(registry().mutex);
+    for (ScratchThread *thread : registry().threads)
+    {
+        stats.arenas++;
+        stats.committed += thread->committed.load(std::memory_order_relaxed);
+        stats.lastFrameUsed += thread->lastFrameUsed.load(std::memory_order_relaxed);
+        stats.peakFrameUsed = std::max(stats.peakFrameUsed, thread->peakFrameUsed.load(std::memory_order_relaxed));
+    }
+
+    return stats;
+}
+
+} // namespace ddls
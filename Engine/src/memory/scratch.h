@@ -0,0 +1,83 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/memory.h"
+#include "memory/virtual_arena.h"
+#include "utils/helper.h"
+
+namespace ddls {
+
+/**
+ * @brief Scratch memory usage aggregated over every thread
+ * 
+ */
+struct DDLS_API ScratchStats
+{
+    u32 arenas;
+    /** @brief Bytes committed by all arenas */
+    MemSize committed;
+    /** @brief Sum of each arena's usage during the last frame it completed */
+    MemSize lastFrameUsed;
+    /** @brief Highest usage of a single arena within one frame */
+    MemSize peakFrameUsed;
+};
+
+struct ScratchThread;
+
+/**
+ * @brief Per-thread scratch arenas, lazily created and recycled at frame boundaries
+ * 
+ * An arena is only ever touched by its own thread, so allocating from it needs no lock.
+ * Allocations made within a Scope last until it closes, even across frame boundaries,
+ * the others until the thread's first use of its arena in a later frame.
+ * 
+ */
+class DDLS_API Scratch : public Helper
+{
+public:
+    static constexpr MemSize ReserveSize = 256ull * 1024 * 1024;
+
+    /**
+     * @brief Rolls the calling thread's arena back to where it was on construction
+     * 
+     * The arena isn't reset while a scope is open on its thread, so that work spanning
+     * a frame boundary, such as a worker job, keeps its allocations.
+     * 
+     */
+    class DDLS_API Scope
+    {
+    public:
+        Scope();
+
+        ~Scope();
+
+        Scope(Scope const&)          = delete;
+        void operator=(Scope const&) = delete;
+
+        VirtualArena &arena();
+
+    private:
+        ScratchThread &_thread;
+        Marker _marker;
+    };
+
+    /**
+     * @brief The calling thread's arena, reset first if a frame boundary passed since its last use
+     * and no Scope is open on the thread
+     * 
+     */
+    static VirtualArena &Arena();
+
+    /**
+     * @brief Marks a frame boundary, every arena is reset the next time its thread requests it
+     * 
+     */
+    static void NextFrame();
+
+    static ScratchStats Stats();
+
+private:
+    static ScratchThread &Current();
+};
+
+} // namespace ddls
@@ -1,36 +1,107 @@
 #include "memory/stack_allocator.h"
 
-#include <cstdlib>
+#include "core/assert.h"
+
 #include <cstring>
+#include <new>
 
 namespace ddls {
 
-StackAllocator::StackAllocator(MemSize size)
+StackAllocator::StackAllocator(MemSize size, MemoryTag tag) :
+    _size(size), _top(0), _highWaterMark(0), _tag(tag)
 {
-    _spInit = (Ptr) malloc(size);
-    _sp = _spInit;
-    _spMin = _sp;
-    _spMax = _sp + size;
-    if (!_sp) throw OutOfMemoryException("Failed to allocate stack!");
+    _base = (u8 *) ::operator new(size, std::align_val_t(MaxAlignment), std::nothrow);
+    if (!_base) DDLS_THROW(OutOfMemoryException("Failed to allocate stack!"));
+    Memory::TrackAllocation(_tag, _size);
 }
 
 StackAllocator::~StackAllocator()
 {
-    free(_spInit);
+#ifdef DDLS_DEBUG
+    // Linear allocators are released wholesale, only overruns are worth reporting
+    _tracker.removeFrom(_base);
+    _tracker.reportDamaged();
+#endif
+    ::operator delete(_base, std::align_val_t(MaxAlignment));
+    Memory::TrackFree(_tag, _size);
+}
+
+Ptr StackAllocator::allocate(MemSize size, Boolean clear, const std::source_location &site)
+{
+    return allocateAligned(size, DefaultAlignment, clear, site);
+}
+
+Ptr StackAllocator::allocateAligned(MemSize size, MemSize alignment, Boolean clear, const std::source_location &site)
+{
+    Assert(isPowerOfTwo(alignment),
+        fmt::format("Alignment {} is not a power of two!", alignment));
+
+    Expected<Ptr, AllocError> allocation = tryAllocate(size, alignment, clear, site);
+    if (!allocation) DDLS_THROW(OutOfMemoryException("Stack is full!"));
+    return allocation.value();
+}
+
+Expected<Ptr, AllocError> StackAllocator::tryAllocate(MemSize size, MemSize alignment, Boolean clear,
+    const std::source_location &site) noexcept
+{
+    if (!isPowerOfTwo(alignment)) return Unexpected(AllocError::InvalidAlignment);
+
+    ptr top = (ptr)_base + _top;
+    // The padding leaves room for the front guard, the back guard follows the allocation
+    MemSize padding = alignForward(top + GuardSize, alignment) - top;
+    MemSize available = _size - _top;
+    if (padding > available || size + GuardSize > available - padding) return Unexpected(AllocError::OutOfMemory);
+
+    u8 *allocation = _base + _top + padding;
+#ifdef DDLS_DEBUG
+    if (!_tracker.add(allocation, size, site)) return Unexpected(AllocError::OutOfMemory);
+#else
+    ignore(site);
+#endif
+    _top += padding + size + GuardSize;
+    if (_top > _highWaterMark) _highWaterMark = _top;
+    if (clear) memset(allocation, 0, size);
+    return (Ptr) allocation;
+}
+
+void StackAllocator::free(Ptr pointer)
+{
+    if (!tryFree(pointer)) DDLS_THROW(OutOfBoundsException("The requested free location isn't on the stack!"));
+#ifdef DDLS_DEBUG
+    // Overruns the noexcept path found, reported where logging may throw
+    _tracker.reportDamaged();
+#endif
+}
+
+Expected<void, AllocError> StackAllocator::tryFree(Ptr pointer) noexcept
+{
+    u8 *location = (u8 *) pointer;
+    if (!(_base + GuardSize <= location && location <= _base + _top)) return Unexpected(AllocError::OutOfBounds);
+#ifdef DDLS_DEBUG
+    _tracker.removeFrom(location);
+#endif
+    // The front guard belongs to the allocation
+    _top = (MemSize)(location - GuardSize - _base);
+    return {};
 }
 
-Ptr StackAllocator::allocate(MemSize size, Boolean clear)
+void StackAllocator::freeToMarker(Marker marker)
 {
-    if (_sp + size > _spMax) throw OutOfMemoryException("Stack is full!");
-    if (clear) memset(_sp, 0, size);
-    _sp += size;
-    return _sp - size;
+    if (!tryFreeToMarker(marker)) DDLS_THROW(OutOfBoundsException("The requested marker is above the stack pointer!"));
+#ifdef DDLS_DEBUG
+    // Overruns the noexcept path found, reported where logging may throw
+    _tracker.reportDamaged();
+#endif
 }
 
-void StackAllocator::free(Ptr ptr)
+Expected<void, AllocError> StackAllocator::tryFreeToMarker(Marker marker) noexcept
 {
-    if (!(_spMin <= ptr && ptr <= _sp)) throw OutOfBoundsException("The requested free location isn't on the stack!");
-    _sp = ptr;
+    if (marker > _top) return Unexpected(AllocError::OutOfBounds);
+#ifdef DDLS_DEBUG
+    _tracker.removeFrom(_base + marker);
+#endif
+    _top = marker;
+    return {};
 }
 
 } // namespace ddls
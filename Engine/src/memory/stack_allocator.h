@@ -3,19 +3,32 @@
 #include "core/defines.h"
 #include "core/memory.h"
 #include "core/error.h"
+#include "core/expected.h"
+#include "memory/marker_scope.h"
+#include "memory/allocation_tracker.h"
 
 namespace ddls {
 
+/**
+ * @brief A linear allocator working in bytes, freed by rolling back to a marker
+ * 
+ */
 class DDLS_API StackAllocator
 {
 public:
     /**
-     * @brief Allocates memory to use as a stack
+     * @brief Rolls the stack back when going out of scope
      * 
+     */
+    using Scope = MarkerScope<StackAllocator>;
+
+    /**
+     * @brief Allocates memory to use as a stack, aligned on MaxAlignment
      * 
-     * @param size The size of the memory region
+     * @param size The size of the memory region in bytes
+     * @param tag The memory tag the region is accounted under
      */
-    explicit StackAllocator(MemSize size = MemSize_default);
+    explicit StackAllocator(MemSize size = MemSize_default, MemoryTag tag = MemoryTag::Miscellaneous);
 
     /**
      * @brief Frees the allocated memory region
@@ -23,28 +36,119 @@ public:
      */
     ~StackAllocator();
 
+    StackAllocator(StackAllocator const&) = delete;
+    void operator=(StackAllocator const&) = delete;
+
+    /**
+     * @brief Allocates memory to a given object without throwing
+     * 
+     * @param size The size of the allocated object in bytes
+     * @param alignment A power of two, up to MaxAlignment is guaranteed by the backing memory
+     * @param clear Whether the memory should be zeroed
+     * @return A pointer to the allocated memory location, or OutOfMemory or InvalidAlignment
+     */
+    Expected<Ptr, AllocError> tryAllocate(MemSize size, MemSize alignment = DefaultAlignment, Boolean clear = true,
+        const std::source_location &site = std::source_location::current()) noexcept;
+
+    /**
+     * @brief Moves the stack pointer without throwing
+     * 
+     * Overruns found in debug builds are logged by the next free(), freeToMarker() or the destructor.
+     * 
+     * @return OutOfBounds if the pointer isn't between the base and the current stack pointer
+     */
+    Expected<void, AllocError> tryFree(Ptr pointer) noexcept;
+
+    /**
+     * @brief Frees every object allocated after the given marker without throwing
+     * 
+     * @return OutOfBounds if the marker is above the current stack pointer
+     */
+    Expected<void, AllocError> tryFreeToMarker(Marker marker) noexcept;
+
+    /**
+     * @brief Allocates memory to a given object with the default alignment
+     * 
+     * @param size The size of the allocated object in bytes
+     * @param clear Whether the memory should be zeroed
+     * @return Ptr A pointer to the allocated memory location
+     */
+    Ptr allocate(MemSize size, Boolean clear = true, const std::source_location &site = std::source_location::current());
+
+    /**
+     * @brief Allocates memory to a given object with the given alignment
+     * 
+     * @param size The size of the allocated object in bytes
+     * @param alignment A power of two, up to MaxAlignment is guaranteed by the backing memory
+     * @param clear Whether the memory should be zeroed
+     * @return Ptr A pointer to the allocated memory location
+     */
+    Ptr allocateAligned(MemSize size, MemSize alignment, Boolean clear = true,
+        const std::source_location &site = std::source_location::current());
+
     /**
-     * @brief Allocates memory to a given object
+     * @brief Allocates an array of count objects of type T
      * 
-     * @param size The size of the allocated object
-     * @param tag The memory tag of the allocated object
-     * @return u32 A pointer to the allocated memory location
      */
-    Ptr allocate(MemSize size, Boolean clear = true);
+    template<typename T>
+    T *allocateArray(MemSize count, Boolean clear = true, const std::source_location &site = std::source_location::current())
+    {
+        return static_cast<T *>(allocateAligned((MemSize)sizeof(T) * count, (MemSize)alignof(T), clear, site));
+    }
 
     /**
      * @brief Frees objects by moving the stack pointer
      * 
-     * @param ptr The new stack pointer
-     * @return u8 An error code, Failure if the new stack pointer is not valid
+     * @param pointer The new stack pointer, must lie between the base and the current stack pointer
+     */
+    void free(Ptr pointer);
+
+    /**
+     * @brief Returns the current position of the stack pointer
+     * 
+     */
+    Marker getMarker() const { return _top; }
+
+    /**
+     * @brief Frees every object allocated after the given marker
+     * 
+     * @param marker A marker previously returned by getMarker()
+     */
+    void freeToMarker(Marker marker);
+
+    /**
+     * @brief Frees every object on the stack
+     * 
+     */
+    void clear() { freeToMarker(0); }
+
+    /**
+     * @brief The capacity of the stack in bytes
+     * 
+     */
+    MemSize size() const { return _size; }
+
+    /**
+     * @brief The number of bytes currently in use, alignment padding and guards included
+     * 
+     */
+    MemSize used() const { return _top; }
+
+    /**
+     * @brief The highest number of bytes ever in use at once
+     * 
      */
-    void free(Ptr ptr);
+    MemSize highWaterMark() const { return _highWaterMark; }
 
 private:
-    Ptr _spInit;
-    Ptr _sp;
-    Ptr _spMin;
-    Ptr _spMax;
+    u8 *_base;
+    MemSize _size;
+    MemSize _top;
+    MemSize _highWaterMark;
+    MemoryTag _tag;
+#ifdef DDLS_DEBUG
+    AllocationTracker _tracker{"StackAllocator"};
+#endif
 };
 
 } // namespace ddls
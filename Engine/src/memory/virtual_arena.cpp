@@ -0,0 +1,202 @@
+#include "memory/virtual_arena.h"
+
+#include "core/assert.h"
+
+#include <cstring>
+
+#ifdef DDLS_PLATFORM_WINDOWS
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace ddls {
+
+#ifdef DDLS_PLATFORM_WINDOWS
+
+MemSize VirtualArena::pageSize()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+
+static u8 *reserveRegion(MemSize size)
+{
+    return (u8 *) VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+static Boolean commitRegion(u8 *address, MemSize size)
+{
+    return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
+static void decommitRegion(u8 *address, MemSize size)
+{
+    VirtualFree(address, size, MEM_DECOMMIT);
+}
+
+static void releaseRegion(u8 *address, MemSize size)
+{
+    ignore(size);
+    VirtualFree(address, 0, MEM_RELEASE);
+}
+
+#else
+
+MemSize VirtualArena::pageSize()
+{
+    static const MemSize size = (MemSize) sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+static u8 *reserveRegion(MemSize size)
+{
+    void *address = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return address == MAP_FAILED ? nullptr : (u8 *) address;
+}
+
+static Boolean commitRegion(u8 *address, MemSize size)
+{
+    return mprotect(address, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+static void decommitRegion(u8 *address, MemSize size)
+{
+    // Drop the pages so they read back as zero, then make the range inaccessible again
+    madvise(address, size, MADV_DONTNEED);
+    mprotect(address, size, PROT_NONE);
+}
+
+static void releaseRegion(u8 *address, MemSize size)
+{
+    munmap(address, size);
+}
+
+#endif
+
+VirtualArena::VirtualArena(MemSize reserveSize, MemoryTag tag, MemSize commitSize) :
+    _committed(0), _top(0), _highWaterMark(0), _tag(tag)
+{
+    _reserved = alignForward(reserveSize, pageSize());
+    _commitSize = alignForward(commitSize ? commitSize : 1, pageSize());
+    _base = reserveRegion(_reserved);
+    if (!_base) DDLS_THROW(OutOfMemoryException("Failed to reserve arena address space!"));
+}
+
+VirtualArena::~VirtualArena()
+{
+#ifdef DDLS_DEBUG
+    // Linear allocators are released wholesale, only overruns are worth reporting
+    _tracker.removeFrom(_base);
+    _tracker.reportDamaged();
+#endif
+    releaseRegion(_base, _reserved);
+    Memory::TrackFree(_tag, _committed);
+}
+
+Ptr VirtualArena::allocate(MemSize size, Boolean clear, const std::source_location &site)
+{
+    return allocateAligned(size, DefaultAlignment, clear, site);
+}
+
+Ptr VirtualArena::allocateAligned(MemSize size, MemSize alignment, Boolean clear, const std::source_location &site)
+{
+    Assert(isPowerOfTwo(alignment),
+        fmt::format("Alignment {} is not a power of two!", alignment));
+
+    Expected<Ptr, AllocError> allocation = tryAllocate(size, alignment, clear, site);
+    if (!allocation) DDLS_THROW(OutOfMemoryException("Arena is full!"));
+    return allocation.value();
+}
+
+Expected<Ptr, AllocError> VirtualArena::tryAllocate(MemSize size, MemSize alignment, Boolean clear,
+    const std::source_location &site) noexcept
+{
+    if (!isPowerOfTwo(alignment)) return Unexpected(AllocError::InvalidAlignment);
+
+    ptr top = (ptr)_base + _top;
+    // The padding leaves room for the front guard, the back guard follows the allocation
+    MemSize padding = alignForward(top + GuardSize, alignment) - top;
+    MemSize available = _reserved - _top;
+    if (padding > available || size + GuardSize > available - padding) return Unexpected(AllocError::OutOfMemory);
+
+    u8 *allocation = _base + _top + padding;
+    MemSize end = _top + padding + size + GuardSize;
+    if (end > _committed && !commit(end)) return Unexpected(AllocError::OutOfMemory);
+#ifdef DDLS_DEBUG
+    if (!_tracker.add(allocation, size, site)) return Unexpected(AllocError::OutOfMemory);
+#else
+    ignore(site);
+#endif
+    _top = end;
+    if (_top > _highWaterMark) _highWaterMark = _top;
+    if (clear) memset(allocation, 0, size);
+    return (Ptr) allocation;
+}
+
+void VirtualArena::free(Ptr pointer)
+{
+    if (!tryFree(pointer)) DDLS_THROW(OutOfBoundsException("The requested free location isn't in the arena!"));
+#ifdef DDLS_DEBUG
+    // Overruns the noexcept path found, reported where logging may throw
+    _tracker.reportDamaged();
+#endif
+}
+
+Expected<void, AllocError> VirtualArena::tryFree(Ptr pointer) noexcept
+{
+    u8 *location = (u8 *) pointer;
+    if (!(_base + GuardSize <= location && location <= _base + _top)) return Unexpected(AllocError::OutOfBounds);
+#ifdef DDLS_DEBUG
+    _tracker.removeFrom(location);
+#endif
+    // The front guard belongs to the allocation
+    _top = (MemSize)(location - GuardSize - _base);
+    return {};
+}
+
+void VirtualArena::freeToMarker(Marker marker)
+{
+    if (!tryFreeToMarker(marker)) DDLS_THROW(OutOfBoundsException("The requested marker is above the arena pointer!"));
+#ifdef DDLS_DEBUG
+    // Overruns the noexcept path found, reported where logging may throw
+    _tracker.reportDamaged();
+#endif
+}
+
+Expected<void, AllocError> VirtualArena::tryFreeToMarker(Marker marker) noexcept
+{
+    if (marker > _top) return Unexpected(AllocError::OutOfBounds);
+#ifdef DDLS_DEBUG
+    _tracker.removeFrom(_base + marker);
+#endif
+    _top = marker;
+    return {};
+}
+
+void VirtualArena::reset(Boolean decommit)
+{
+    freeToMarker(0);
+    if (decommit && _committed)
+    {
+        decommitRegion(_base, _committed);
+        Memory::TrackFree(_tag, _committed);
+        _committed = 0;
+    }
+}
+
+Boolean VirtualArena::commit(MemSize size) noexcept
+{
+    // Commit in steps of at least _commitSize to keep system calls rare
+    MemSize target = alignForward(size, _commitSize);
+    if (target > _reserved) target = _reserved;
+
+    if (!commitRegion(_base + _committed, target - _committed)) return false;
+    Memory::TrackAllocation(_tag, target - _committed);
+    _committed = target;
+    return true;
+}
+
+} // namespace ddls
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "core/defines.h"
+#include "core/memory.h"
+#include "core/error.h"
+#include "core/expected.h"
+#include "memory/marker_scope.h"
+#include "memory/allocation_tracker.h"
+
+namespace ddls {
+
+/**
+ * @brief A linear allocator reserving address space up front and committing pages on demand
+ * 
+ * The arena never relocates, so pointers stay valid until freed, and it never needs to be pre-sized
+ * beyond the reservation, which only costs address space.
+ * 
+ */
+class DDLS_API VirtualArena
+{
+public:
+    /**
+     * @brief Rolls the arena back when going out of scope
+     * 
+     */
+    using Scope = MarkerScope<VirtualArena>;
+
+    static constexpr MemSize DefaultReserveSize = 4ull * 1024 * 1024 * 1024;
+    static constexpr MemSize DefaultCommitSize = 64 * 1024;
+
+    /**
+     * @brief Reserves address space without committing any memory
+     * 
+     * @param reserveSize The maximum size of the arena in bytes
+     * @param tag The memory tag committed pages are accounted under
+     * @param commitSize The minimum number of bytes committed at once, rounded to pages
+     */
+    explicit VirtualArena(MemSize reserveSize = DefaultReserveSize, MemoryTag tag = MemoryTag::Miscellaneous,
+        MemSize commitSize = DefaultCommitSize);
+
+    /**
+     * @brief Releases the whole reservation
+     * 
+     */
+    ~VirtualArena();
+
+    VirtualArena(VirtualArena const&)   = delete;
+    void operator=(VirtualArena const&) = delete;
+
+    /**
+     * @brief Allocates memory to a given object without throwing, committing pages if needed
+     * 
+     * @param size The size of the allocated object in bytes
+     * @param alignment A power of two, up to the page size is guaranteed by the reservation
+     * @param clear Whether the memory should be zeroed
+     * @return A pointer to the allocated memory location, or OutOfMemory or InvalidAlignment
+     */
+    Expected<Ptr, AllocError> tryAllocate(MemSize size, MemSize alignment = DefaultAlignment, Boolean clear = true,
+        const std::source_location &site = std::source_location::current()) noexcept;
+
+    /**
+     * @brief Moves the arena pointer without throwing
+     * 
+     * Overruns found in debug builds are logged by the next free(), freeToMarker() or the destructor.
+     * 
+     * @return OutOfBounds if the pointer isn't between the base and the current arena pointer
+     */
+    Expected<void, AllocError> tryFree(Ptr pointer) noexcept;
+
+    /**
+     * @brief Frees every object allocated after the given marker without throwing
+     * 
+     * @return OutOfBounds if the marker is above the current arena pointer
+     */
+    Expected<void, AllocError> tryFreeToMarker(Marker marker) noexcept;
+
+    /**
+     * @brief Allocates memory to a given object with the default alignment
+     * 
+     * @param size The size of the allocated object in bytes
+     * @param clear Whether the memory should be zeroed
+     * @return Ptr A pointer to the allocated memory location
+     */
+    Ptr allocate(MemSize size, Boolean clear = true, const std::source_location &site = std::source_location::current());
+
+    /**
+     * @brief Allocates memory to a given object with the given alignment, committing pages if needed
+     * 
+     * @param size The size of the allocated object in bytes
+     * @param alignment A power of two, up to the page size is guaranteed by the reservation
+     * @param clear Whether the memory should be zeroed
+     * @return Ptr A pointer to the allocated memory location
+     */
+    Ptr allocateAligned(MemSize size, MemSize alignment, Boolean clear = true,
+        const std::source_location &site = std::source_location::current());
+
+    /**
+     * @brief Allocates an array of count objects of type T
+     * 
+     */
+    template<typename T>
+    T *allocateArray(MemSize count, Boolean clear = true, const std::source_location &site = std::source_location::current())
+    {
+        return static_cast<T *>(allocateAligned((MemSize)sizeof(T) * count, (MemSize)alignof(T), clear, site));
+    }
+
+    /**
+     * @brief Frees objects by moving the arena pointer
+     * 
+     * @param pointer The new arena pointer, must lie between the base and the current arena pointer
+     */
+    void free(Ptr pointer);
+
+    /**
+     * @brief Returns the current position of the arena pointer
+     * 
+     */
+    Marker getMarker() const { return _top; }
+
+    /**
+     * @brief Frees every object allocated after the given marker, pages stay committed
+     * 
+     * @param marker A marker previously returned by getMarker()
+     */
+    void freeToMarker(Marker marker);
+
+    /**
+     * @brief Frees every object in the arena
+     * 
+     * @param decommit Whether committed pages are given back to the system
+     */
+    void reset(Boolean decommit = false);
+
+    /**
+     * @brief The size of the reservation in bytes
+     * 
+     */
+    MemSize reserved() const { return _reserved; }
+
+    /**
+     * @brief The number of bytes backed by memory
+     * 
+     */
+    MemSize committed() const { return _committed; }
+
+    /**
+     * @brief The number of bytes currently in use, alignment padding and guards included
+     * 
+     */
+    MemSize used() const { return _top; }
+
+    /**
+     * @brief The highest number of bytes ever in use at once
+     * 
+     */
+    MemSize highWaterMark() const { return _highWaterMark; }
+
+    /**
+     * @brief The system's virtual memory page size
+     * 
+     */
+    static MemSize pageSize();
+
+private:
+    Boolean commit(MemSize size) noexcept;
+
+    u8 *_base;
+    MemSize _reserved;
+    MemSize _committed;
+    MemSize _commitSize;
+    MemSize _top;
+    MemSize _highWaterMark;
+    MemoryTag _tag;
+#ifdef DDLS_DEBUG
+    AllocationTracker _tracker{"VirtualArena"};
+#endif
+};
+
+} // namespace ddls
@@ -122,5 +122,7 @@ int main()
     glfwDestroyWindow(window);
     glfwTerminate();
 
+    Memory::Report();
+
     return 0;
 }
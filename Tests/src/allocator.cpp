@@ -1,5 +1,16 @@
 #include <daedalus.h>
 #include <memory/stack_allocator.h>
+#include <memory/frame_allocator.h>
+#include <memory/virtual_arena.h>
+#include <memory/scratch.h>
+#include <memory/memory_resource.h>
+#include <memory/pool_allocator.h>
+#include <memory/allocation_tracker.h>
+
+#include <map>
+#include <vector>
+
+#include <thread>
 
 #include "test.h"
 
@@ -7,17 +18,186 @@ using namespace ddls;
 
 int main()
 {
-    StackAllocator allocator(16*sizeof(u32));
-    Ptr arr = allocator.allocate(8*sizeof(f32));
+    StackAllocator allocator(64*sizeof(f32));
+    f32 *arr = allocator.allocateArray<f32>(8);
+    ASSERT(allocator.used() == 8*sizeof(f32) + 2*GuardSize)
     arr[1] = 4.0f;
     allocator.free(arr);
-    f32 tmp = (f32)(arr+sizeof(f32))[0];
-    ASSERT(!((arr+sizeof(f32))[0]))
+    ASSERT(allocator.used() == 0)
+
+    arr = allocator.allocateArray<f32>(2, false);
+    ASSERT(!(arr[1] < 4.0f || arr[1] > 4.0f))
+
+    {
+        ASSERT_THROWS(allocator.free(nullptr), OutOfBoundsException)
+    }
+    {
+        ASSERT_THROWS(allocator.allocate(allocator.size()), OutOfMemoryException)
+    }
+
+    // The non-throwing API reports errors as values
+    {
+        Expected<Ptr, AllocError> failed = allocator.tryAllocate(allocator.size() + 1);
+        ASSERT(!failed && failed.error() == AllocError::OutOfMemory)
+        ASSERT(allocator.tryAllocate(4, 3).error() == AllocError::InvalidAlignment)
+        ASSERT(allocator.tryFreeToMarker(allocator.size()).error() == AllocError::OutOfBounds)
+        Expected<Ptr, AllocError> allocated = allocator.tryAllocate(4);
+        ASSERT(allocated.hasValue() && allocator.tryFree(allocated.value()))
+    }
+
+    // Alignment is honoured past an odd-sized allocation
+    allocator.clear();
+    allocator.allocate(1);
+    Ptr aligned = allocator.allocateAligned(4, MaxAlignment);
+    ASSERT((ptr)aligned % MaxAlignment == 0)
+
+    // Markers and scopes roll back every later allocation
+    allocator.clear();
+    allocator.allocate(4);
+    Marker marker = allocator.getMarker();
+    {
+        StackAllocator::Scope scope(allocator);
+        allocator.allocate(32);
+        ASSERT(allocator.used() > marker)
+    }
+    ASSERT(allocator.getMarker() == marker)
+    allocator.allocate(8);
+    allocator.freeToMarker(marker);
+    ASSERT(allocator.used() == marker)
+    ASSERT(allocator.highWaterMark() >= 36)
+    {
+        ASSERT_THROWS(allocator.freeToMarker(allocator.size()), OutOfBoundsException)
+    }
+
+    // Frame memory is only recycled when the same frame index begins again
+    FrameAllocator frames(2, 128);
+    frames.beginFrame(0);
+    frames.allocate(48);
+    frames.beginFrame(1);
+    ASSERT(frames.current().used() == 0)
+    frames.allocate(16);
+    frames.beginFrame(0);
+    ASSERT(frames.current().used() == 0)
+    ASSERT(frames.framesInFlight() == 2)
+
+    // Allocators account their memory under their tag
+    MemoryTagStats before = Memory::Stats(MemoryTag::Scratch);
+    {
+        StackAllocator scratch(256, MemoryTag::Scratch);
+        ASSERT(Memory::Stats(MemoryTag::Scratch).bytes == before.bytes + 256)
+    }
+    ASSERT(Memory::Stats(MemoryTag::Scratch).bytes == before.bytes)
+    ASSERT(Memory::Stats(MemoryTag::Scratch).allocations == before.allocations + 1)
+
+    // The arena commits pages as it grows and never relocates
+    VirtualArena arena(1ull << 30, MemoryTag::Scratch);
+    ASSERT(arena.committed() == 0)
+    u8 *first = arena.allocateArray<u8>(16);
+    ASSERT(arena.committed() >= VirtualArena::pageSize())
+    u8 *large = arena.allocateArray<u8>(8 * VirtualArena::DefaultCommitSize);
+    ASSERT(large > first)
+    large[8 * VirtualArena::DefaultCommitSize - 1] = 1;
+    ASSERT(arena.committed() >= arena.used())
+    {
+        VirtualArena::Scope scope(arena);
+        arena.allocate(64);
+    }
+    ASSERT(arena.used() == 16 + 8 * VirtualArena::DefaultCommitSize + 4 * GuardSize)
+    arena.reset(true);
+    ASSERT(arena.committed() == 0 && arena.used() == 0)
+    ASSERT(arena.allocateArray<u8>(16) == first)
+
+    // Each thread gets its own scratch arena, recycled after a frame boundary
+    VirtualArena *mainScratch = &Scratch::Arena();
+    VirtualArena *workerScratch = nullptr;
+    std::thread worker([&] {
+        workerScratch = &Scratch::Arena();
+        workerScratch->allocate(128);
+    });
+    worker.join();
+    ASSERT(workerScratch != mainScratch)
+    Scratch::Arena().allocate(256);
+    ASSERT(Scratch::Arena().used() == 256 + 2 * GuardSize)
+    Scratch::NextFrame();
+    ASSERT(Scratch::Arena().used() == 0)
+    ASSERT(Scratch::Stats().arenas == 1)
+    ASSERT(Scratch::Stats().peakFrameUsed == 256 + 2 * GuardSize)
+
+    // Work spanning a frame boundary keeps its scratch allocations until its scope closes
+    std::thread job([] {
+        Scratch::Scope scope;
+        u8 *earlier = scope.arena().allocateArray<u8>(64);
+        Scratch::NextFrame();
+        ASSERT(Scratch::Arena().used() == 64 + 2 * GuardSize)
+        ASSERT(scope.arena().allocateArray<u8>(64) > earlier)
+    });
+    job.join();
+    {
+        Scratch::Scope scope;
+        scope.arena().allocate(32);
+        Scratch::NextFrame();
+    }
+    ASSERT(Scratch::Arena().used() == 0)
+
+    // Heap allocations are accounted under their tag and released by Free
+    MemoryTagStats files = Memory::Stats(MemoryTag::Files);
+    u8 *heap = (u8 *) Memory::Allocate(100, MemoryTag::Files);
+    ASSERT((ptr)heap % DefaultAlignment == 0)
+    ASSERT(Memory::Stats(MemoryTag::Files).bytes == files.bytes + 100)
+    Memory::Free(heap);
+    ASSERT(Memory::Stats(MemoryTag::Files).bytes == files.bytes)
+    ASSERT(Memory::ReportLeaks() == 0)
+
+#ifdef DDLS_DEBUG
+    // Writes past an allocation land in its guard bytes and are reported
+    {
+        u8 buffer[64 + 2 * GuardSize];
+        AllocationTracker tracker("Test");
+        tracker.add(buffer + GuardSize, 64, std::source_location::current());
+        ASSERT(tracker.check() == 0)
+        buffer[GuardSize + 64] = 0;
+        ASSERT(tracker.check() == 1)
+        ASSERT(tracker.reportLeaks() == 1)
+        ASSERT(!tracker.remove(buffer, std::source_location::current()))
+        // Only logged once out of the noexcept path, even after the memory is reused
+        tracker.removeFrom(buffer);
+        ASSERT(tracker.count() == 0)
+        buffer[GuardSize + 64] = GuardByte;
+        ASSERT(tracker.reportDamaged() == 1 && tracker.reportDamaged() == 0)
+    }
+
+    // Records stay ordered whatever order they're added in
+    {
+        u8 buffer[3 * (16 + 2 * GuardSize)];
+        u8 *blocks[3];
+        for (u32 i = 0; i < 3; i++) blocks[i] = buffer + i * (16 + 2 * GuardSize) + GuardSize;
+        AllocationTracker tracker("Test");
+        ASSERT(tracker.reserve(3))
+        ASSERT(tracker.add(blocks[2], 16, std::source_location::current()))
+        ASSERT(tracker.add(blocks[0], 16, std::source_location::current()))
+        ASSERT(tracker.add(blocks[1], 16, std::source_location::current()))
+        ASSERT(tracker.remove(blocks[1], std::source_location::current()) && tracker.count() == 2)
+        tracker.removeFrom(blocks[1]);
+        ASSERT(tracker.count() == 1 && tracker.remove(blocks[0], std::source_location::current()))
+    }
+#endif
 
-    arr = allocator.allocate(2*sizeof(f32), false);
-    ASSERT(!((f32)arr[1] != 4.0f))
+    // Standard containers can draw from the engine allocators
+    StackAllocator containerStack(1024);
+    StackResource stackResource(containerStack);
+    std::pmr::vector<u32> values(&stackResource);
+    values.reserve(16);
+    values.push_back(42);
+    ASSERT(containerStack.used() >= 16 * sizeof(u32))
 
-    ASSERT_THROWS(allocator.free(0), OutOfBoundsException)
+    PoolAllocator nodes(64, 8, true);
+    PoolResource poolResource(nodes);
+    {
+        std::pmr::map<u32, u32> lookup(&poolResource);
+        for (u32 i = 0; i < 10; i++) lookup[i] = i;
+        ASSERT(nodes.used() == 10)
+    }
+    ASSERT(nodes.used() == 0)
 
     TEST_SUCCESS
 }
@@ -0,0 +1,94 @@
+#include <daedalus.h>
+#include <core/archive.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "test.h"
+
+using namespace ddls;
+
+int main()
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "ddls_archive_test.dpak";
+
+    ArchiveWriter writer(64);
+    writer.add("shaders/shader.vert.glsl", {'v', 'e', 'r', 't'});
+    writer.add("empty", {});
+    for (u32 i = 0; i < 100; i++)
+    {
+        std::string name = "file" + std::to_string(i);
+        writer.add(name, std::vector<char>(name.begin(), name.end()));
+    }
+    ASSERT(writer.write(path))
+
+    // Every entry is found by name, and its payload is aligned in the mapping
+    Archive archive;
+    ASSERT(archive.mount(path))
+    ASSERT(archive.entries().size() == 102)
+    const ArchiveEntry *vert = archive.find("shaders/shader.vert.glsl");
+    ASSERT(vert && vert->size == 4 && vert->compression == Compression::None)
+    ASSERT(std::memcmp(archive.view(*vert).data(), "vert", 4) == 0)
+    ASSERT((ptr)archive.view(*vert).data() % 64 == 0)
+    for (u32 i = 0; i < 100; i++)
+    {
+        std::string name = "file" + std::to_string(i);
+        const ArchiveEntry *entry = archive.find(name);
+        ASSERT(entry && entry->size == name.size())
+        std::string contents(entry->size, '\0');
+        ASSERT(archive.read(*entry, contents.data()) && contents == name)
+    }
+    const ArchiveEntry *empty = archive.find("empty");
+    ASSERT(empty && empty->size == 0)
+    ASSERT(archive.find("missing") == nullptr)
+
+    // Compressed entries are split in blocks decoded by several threads
+    std::vector<char> text;
+    while (text.size() < 3 * 1024 * 1024)
+    {
+        std::string line = "texture " + std::to_string(text.size() % 977) + "\n";
+        text.insert(text.end(), line.begin(), line.end());
+    }
+    std::vector<char> noise(100000);
+    std::mt19937 random(3);
+    for (char &byte : noise) byte = (char) random();
+    ArchiveWriter compressedWriter(16, 64 * 1024);
+    compressedWriter.add("text", text, Compression::Lz4Blocks);
+    compressedWriter.add("noise", noise, Compression::Lz4Blocks);
+    ASSERT(compressedWriter.write(path))
+
+    Archive compressed;
+    ASSERT(compressed.mount(path))
+    const ArchiveEntry *textEntry = compressed.find("text");
+    ASSERT(textEntry->compression == Compression::Lz4Blocks && textEntry->storedSize < text.size() / 2)
+    WorkerPool workers(4);
+    std::vector<char> decoded(textEntry->size);
+    ASSERT(compressed.read(*textEntry, decoded.data(), &workers) && decoded == text)
+    std::fill(decoded.begin(), decoded.end(), 0);
+    ASSERT(compressed.read(*textEntry, decoded.data()) && decoded == text)
+    // Compression is dropped when it doesn't pay
+    const ArchiveEntry *noiseEntry = compressed.find("noise");
+    ASSERT(noiseEntry->compression == Compression::None && noiseEntry->size == noise.size())
+
+    // Anything else is refused
+    {
+        std::ofstream corrupt(path, std::ios::binary | std::ios::trunc);
+        corrupt << "not an archive at all";
+    }
+    Archive invalid;
+    ASSERT(!invalid.mount(path))
+    ASSERT(!invalid.mount(path.parent_path() / "ddls_missing.dpak"))
+    {
+        std::ofstream truncated(path, std::ios::binary | std::ios::trunc);
+        truncated << "DDL";
+    }
+    ASSERT(!invalid.mount(path) && invalid.entries().empty())
+    // A failed remount leaves nothing of the previous archive behind
+    ASSERT(!compressed.mount(path) && compressed.entries().empty() && !compressed.find("text"))
+
+    std::filesystem::remove(path);
+
+    TEST_SUCCESS
+}
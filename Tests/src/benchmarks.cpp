@@ -0,0 +1,224 @@
+#include <daedalus.h>
+#include <memory/stack_allocator.h>
+#include <memory/frame_allocator.h>
+#include <memory/pool_allocator.h>
+#include <memory/virtual_arena.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ddls;
+
+/**
+ * Allocator throughput and latency benchmarks, reported as JSON.
+ * Usage: Benchmarks [output.json], writes to the standard output by default.
+ *
+ * Latencies are sampled per batch of BatchSize operations to keep the clock's
+ * own cost out of the measurement, percentiles are per-operation averages of a batch.
+ */
+
+static constexpr u32 BatchSize = 64;
+static constexpr u32 Batches = 20000;
+static constexpr u32 PatternSize = 1024;
+
+struct Request
+{
+    MemSize size;
+    MemSize alignment;
+};
+
+struct Result
+{
+    std::string name;
+    u32 threads;
+    u64 operations;
+    f64 seconds;
+    std::vector<f64> samples;
+};
+
+using Clock = std::chrono::steady_clock;
+
+/** @brief Deterministic mixed sizes in [16, 4096] and alignments in {8, 16, 32, 64} */
+static std::vector<Request> requestPattern()
+{
+    std::vector<Request> pattern(PatternSize);
+    u32 state = 0x9E3779B9;
+    for (auto &request : pattern)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        // Skewed towards small sizes like real workloads
+        u32 bucket = state % 8;
+        request.size = 16 + (state >> 8) % (bucket < 6 ? 256 : 4081);
+        request.alignment = (MemSize) 8 << ((state >> 4) % 4);
+    }
+    return pattern;
+}
+
+/** @brief Deterministic order in which a batch's allocations are released */
+static std::vector<u32> releaseOrder()
+{
+    std::vector<u32> order(BatchSize);
+    for (u32 i = 0; i < BatchSize; i++) order[i] = (i * 37) % BatchSize;
+    return order;
+}
+
+/**
+ * Runs the given workload on each thread, a workload runs one batch per call.
+ * @tparam MakeWorkload Creates the per-thread state, returning a callable taking the batch index.
+ */
+template<typename MakeWorkload>
+static Result run(const std::string &name, u32 threadCount, MakeWorkload makeWorkload)
+{
+    std::vector<std::vector<f64>> samples(threadCount);
+    std::vector<std::thread> threads;
+
+    auto start = Clock::now();
+    for (u32 t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&, t] {
+            auto workload = makeWorkload();
+            samples[t].reserve(Batches);
+            for (u32 batch = 0; batch < Batches; batch++)
+            {
+                auto batchStart = Clock::now();
+                workload(batch);
+                auto batchEnd = Clock::now();
+                samples[t].push_back(std::chrono::duration<f64, std::nano>(batchEnd - batchStart).count() / BatchSize);
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    auto end = Clock::now();
+
+    Result result{name, threadCount, (u64) threadCount * Batches * BatchSize,
+        std::chrono::duration<f64>(end - start).count(), {}};
+    for (auto &threadSamples : samples)
+        result.samples.insert(result.samples.end(), threadSamples.begin(), threadSamples.end());
+    std::sort(result.samples.begin(), result.samples.end());
+
+    return result;
+}
+
+static f64 percentile(const std::vector<f64> &sorted, f64 p)
+{
+    return sorted[std::min((size_t)(p * (f64) sorted.size()), sorted.size() - 1)];
+}
+
+static const std::vector<Request> Pattern = requestPattern();
+static const std::vector<u32> Order = releaseOrder();
+
+static std::vector<Result> runAll(u32 threadCount)
+{
+    std::vector<Result> results;
+
+    results.push_back(run("StackAllocator", threadCount, [] {
+        return [stack = std::make_shared<StackAllocator>(BatchSize * 8192)](u32 batch) {
+            Marker marker = stack->getMarker();
+            for (u32 i = 0; i < BatchSize; i++)
+            {
+                const Request &request = Pattern[(batch * BatchSize + i) % PatternSize];
+                stack->allocateAligned(request.size, request.alignment, false);
+            }
+            stack->freeToMarker(marker);
+        };
+    }));
+
+    results.push_back(run("VirtualArena", threadCount, [] {
+        return [arena = std::make_shared<VirtualArena>(1ull << 30)](u32 batch) {
+            Marker marker = arena->getMarker();
+            for (u32 i = 0; i < BatchSize; i++)
+            {
+                const Request &request = Pattern[(batch * BatchSize + i) % PatternSize];
+                arena->allocateAligned(request.size, request.alignment, false);
+            }
+            arena->freeToMarker(marker);
+        };
+    }));
+
+    results.push_back(run("FrameAllocator", threadCount, [] {
+        return [frames = std::make_shared<FrameAllocator>(2, BatchSize * 8192)](u32 batch) {
+            // One batch per frame, the allocator recycles the frame two batches later
+            frames->beginFrame(batch % frames->framesInFlight());
+            for (u32 i = 0; i < BatchSize; i++)
+            {
+                const Request &request = Pattern[(batch * BatchSize + i) % PatternSize];
+                frames->allocateAligned(request.size, request.alignment, false);
+            }
+        };
+    }));
+
+    results.push_back(run("PoolAllocator", threadCount, [] {
+        auto pool = std::make_shared<PoolAllocator>(256, BatchSize, false, 64);
+        auto blocks = std::make_shared<std::vector<Ptr>>(BatchSize);
+        return [pool, blocks](u32 batch) {
+            ignore(batch);
+            for (u32 i = 0; i < BatchSize; i++) (*blocks)[i] = pool->allocate();
+            for (u32 i = 0; i < BatchSize; i++) pool->free((*blocks)[Order[i]]);
+        };
+    }));
+
+    results.push_back(run("malloc", threadCount, [] {
+        auto blocks = std::make_shared<std::vector<Ptr>>(BatchSize);
+        return [blocks](u32 batch) {
+            for (u32 i = 0; i < BatchSize; i++)
+            {
+                const Request &request = Pattern[(batch * BatchSize + i) % PatternSize];
+                (*blocks)[i] = ::operator new(request.size, std::align_val_t(request.alignment));
+            }
+            for (u32 i = 0; i < BatchSize; i++)
+            {
+                const Request &request = Pattern[(batch * BatchSize + Order[i]) % PatternSize];
+                ::operator delete((*blocks)[Order[i]], std::align_val_t(request.alignment));
+            }
+        };
+    }));
+
+    return results;
+}
+
+static void writeJson(std::ostream &out, const std::vector<Result> &results)
+{
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result &result = results[i];
+        out << "    {\"name\": \"" << result.name << "\""
+            << ", \"threads\": " << result.threads
+            << ", \"operations\": " << result.operations
+            << ", \"ops_per_second\": " << (f64) result.operations / result.seconds
+            << ", \"latency_ns\": {"
+            << "\"p50\": " << percentile(result.samples, 0.50)
+            << ", \"p90\": " << percentile(result.samples, 0.90)
+            << ", \"p99\": " << percentile(result.samples, 0.99)
+            << ", \"p999\": " << percentile(result.samples, 0.999)
+            << ", \"max\": " << result.samples.back()
+            << "}}" << (i + 1 < results.size() ? "," : "") << '\n';
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char **argv)
+{
+    u32 threadCount = std::clamp(std::thread::hardware_concurrency(), 2u, 8u);
+
+    std::vector<Result> results = runAll(1);
+    std::vector<Result> contended = runAll(threadCount);
+    results.insert(results.end(), contended.begin(), contended.end());
+
+    if (argc > 1)
+    {
+        std::ofstream file(argv[1]);
+        writeJson(file, results);
+    }
+    else writeJson(std::cout, results);
+
+    return 0;
+}
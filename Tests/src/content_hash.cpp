@@ -0,0 +1,39 @@
+#include <daedalus.h>
+#include <core/content_hash.h>
+
+#include <cstring>
+#include <vector>
+
+#include "test.h"
+
+using namespace ddls;
+
+static u64 hashOf(const char *string)
+{
+    return ContentHash::Of(string, std::strlen(string));
+}
+
+int main()
+{
+    // Reference XXH64 values, below and above the 32-byte stripe
+    ASSERT(hashOf("") == 0xef46db3751d8e999ull)
+    ASSERT(hashOf("abc") == 0x44bc2cf5ad770999ull)
+    ASSERT(hashOf("Nobody inspects the spammish repetition") == 0xfbcea83c8a378bf1ull)
+    ASSERT(ContentHash::Of("abc", 3, 1) != hashOf("abc"))
+
+    // Every byte counts, wherever it is and however the buffer is aligned
+    std::vector<char> contents(1000);
+    for (u64 i = 0; i < contents.size(); i++) contents[i] = (char) (i * 31);
+    u64 hash = ContentHash::Of(contents.data(), contents.size());
+    for (u64 i : {0ull, 31ull, 32ull, 500ull, 999ull})
+    {
+        contents[i] ^= 1;
+        ASSERT(ContentHash::Of(contents.data(), contents.size()) != hash)
+        contents[i] ^= 1;
+    }
+    std::vector<char> shifted(contents.size() + 1);
+    std::memcpy(shifted.data() + 1, contents.data(), contents.size());
+    ASSERT(ContentHash::Of(shifted.data() + 1, contents.size()) == hash)
+
+    TEST_SUCCESS
+}
@@ -0,0 +1,78 @@
+#include <daedalus.h>
+#include <core/hash_map.h>
+#include <core/string_id.h>
+
+#include <map>
+#include <random>
+#include <string>
+
+#include "test.h"
+
+using namespace ddls;
+
+int main()
+{
+    // Ids depend on the contents only, and literals hash at compile time
+    static_assert("shader.vert.glsl"_sid == StringId("shader.vert.glsl"));
+    static_assert(StringId("") == StringId());
+    char path[] = "shader.vert.glsl";
+    std::string copy(path);
+    ASSERT(StringId(path) == StringId(copy))
+    ASSERT(StringId(path) != StringId("shader.frag.glsl"))
+
+    HashMap<StringId, u32> textures(MemoryTag::Textures);
+    ASSERT(textures.find("missing") == nullptr)
+    textures["grass.png"] = 1;
+    ASSERT(textures.tryEmplace(copy, 2u).second)
+    ASSERT(!textures.tryEmplace("grass.png", 3u).second)
+    ASSERT(*textures.find("grass.png") == 1)
+    ASSERT(*textures.find(path) == 2)
+    ASSERT(textures.size() == 2)
+    ASSERT(Memory::Stats(MemoryTag::Textures).bytes > 0)
+
+    // Random inserts and erases agree with std::map, through growth and backward shifts
+    HashMap<u32, u32> values;
+    std::map<u32, u32> reference;
+    std::mt19937 random(42);
+    for (u32 i = 0; i < 20000; i++)
+    {
+        u32 key = random() % 512;
+        if (random() % 3)
+        {
+            values[key] = i;
+            reference[key] = i;
+        }
+        else
+        {
+            ASSERT(values.erase(key) == (reference.erase(key) == 1))
+        }
+    }
+    ASSERT(values.size() == reference.size())
+    for (u32 key = 0; key < 512; key++)
+    {
+        const u32 *value = values.find(key);
+        ASSERT((value != nullptr) == reference.contains(key))
+        ASSERT(!value || *value == reference[key])
+    }
+    u64 visited = 0;
+    for (auto &entry : values)
+    {
+        ASSERT(reference[entry.first] == entry.second)
+        visited++;
+    }
+    ASSERT(visited == reference.size())
+
+    // Values are destroyed with the map
+    {
+        HashMap<u32, std::string> names;
+        names.reserve(100);
+        u64 capacity = names.capacity();
+        for (u32 i = 0; i < 100; i++) names[i] = std::to_string(i) + " is a long enough string to allocate";
+        ASSERT(names.capacity() == capacity)
+        ASSERT(names.erase(50) && !names.contains(50) && names.size() == 99)
+        names.clear();
+        ASSERT(names.empty())
+    }
+
+    TEST_SUCCESS
+}
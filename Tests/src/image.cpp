@@ -0,0 +1,114 @@
+#include <daedalus.h>
+#include <core/image.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "test.h"
+
+using namespace ddls;
+
+// Odd sizes leave remainders for every kernel's scalar tail
+static constexpr u16 Width = 37;
+static constexpr u16 Height = 11;
+static constexpr u64 Pixels = (u64) Width * Height;
+
+struct Outputs
+{
+    std::vector<u8> expanded;
+    std::vector<u8> flipped;
+    std::vector<u8> premultiplied;
+    std::vector<u8> srgb;
+    std::vector<u8> downsampled;
+    std::vector<u8> downsampledColumn;
+};
+
+static Outputs run(const std::vector<u8> &pixels, const std::vector<f32> &linear)
+{
+    Outputs outputs;
+    outputs.expanded.resize(Pixels * 4);
+    Image::ExpandRgbToRgba(pixels.data(), outputs.expanded.data(), Pixels);
+
+    outputs.flipped = pixels;
+    Image::FlipVertically(outputs.flipped.data(), (u64) Width * 4, Height);
+
+    outputs.premultiplied = pixels;
+    Image::Premultiply(outputs.premultiplied.data(), Pixels, 4);
+
+    outputs.srgb.resize(linear.size());
+    Image::LinearToSrgb(linear.data(), outputs.srgb.data(), linear.size());
+
+    outputs.downsampled.resize((Width / 2) * (Height / 2) * 4);
+    Image::Downsample(pixels.data(), Width, Height, 4, outputs.downsampled.data());
+    outputs.downsampledColumn.resize((Height / 2) * 4);
+    Image::Downsample(pixels.data(), 1, Height, 4, outputs.downsampledColumn.data());
+
+    return outputs;
+}
+
+int main()
+{
+    std::mt19937 random(11);
+    std::vector<u8> pixels(Pixels * 4);
+    for (u8 &byte : pixels) byte = (u8) random();
+    std::vector<f32> linear(1000);
+    for (u64 i = 0; i < linear.size(); i++) linear[i] = (f32) i / 900.0f - 0.05f;
+    linear[3] = std::numeric_limits<f32>::quiet_NaN();
+
+    // Every color and alpha pair
+    std::vector<u8> pairs(256 * 256 * 4);
+    for (u32 i = 0; i < 256 * 256; i++)
+    {
+        pairs[4 * i] = pairs[4 * i + 1] = pairs[4 * i + 2] = (u8) i;
+        pairs[4 * i + 3] = (u8) (i >> 8);
+    }
+
+    ASSERT(Image::SetLevel(SimdLevel::Scalar))
+    Outputs scalar = run(pixels, linear);
+    std::vector<u8> scalarPairs = pairs;
+    Image::Premultiply(scalarPairs.data(), 256 * 256, 4);
+    for (u32 i = 0; i < 256 * 256; i++)
+    {
+        ASSERT(scalarPairs[4 * i] == (u8) std::lround((i & 255) * (i >> 8) / 255.0))
+    }
+
+    // Spot checks of the scalar kernels
+    ASSERT(scalar.expanded[3] == 0xFF && scalar.expanded[4] == pixels[3])
+    ASSERT(scalar.flipped[0] == pixels[(Height - 1u) * Width * 4u])
+    u32 alpha = pixels[3];
+    ASSERT(scalar.premultiplied[0] == (pixels[0] * alpha + 127) / 255 && scalar.premultiplied[3] == alpha)
+    ASSERT(scalar.srgb[0] == 0 && scalar.srgb[3] == 0 && scalar.srgb[999] == 255)
+    u32 sum = (u32) pixels[0] + pixels[4] + pixels[Width * 4] + pixels[Width * 4 + 4];
+    ASSERT(scalar.downsampled[0] == (sum + 2) / 4)
+
+    // The round trip through linear is exact for every 8-bit value
+    std::vector<u8> values(256);
+    for (u32 i = 0; i < 256; i++) values[i] = (u8) i;
+    std::vector<f32> decoded(256);
+    Image::SrgbToLinear(values.data(), decoded.data(), 256);
+    ASSERT(std::fabs(decoded[255] - 1.0f) < 1e-6f && decoded[0] < 1e-6f)
+    std::vector<u8> encoded(256);
+    Image::LinearToSrgb(decoded.data(), encoded.data(), 256);
+    ASSERT(encoded == values)
+
+    // Every instruction set the CPU has produces the same bytes
+    for (SimdLevel level : {SimdLevel::Sse2, SimdLevel::Avx2, SimdLevel::Neon})
+    {
+        if (!Image::SetLevel(level)) continue;
+        Outputs simd = run(pixels, linear);
+        ASSERT(simd.expanded == scalar.expanded)
+        ASSERT(simd.flipped == scalar.flipped)
+        ASSERT(simd.premultiplied == scalar.premultiplied)
+        ASSERT(simd.srgb == scalar.srgb)
+        ASSERT(simd.downsampled == scalar.downsampled)
+        ASSERT(simd.downsampledColumn == scalar.downsampledColumn)
+        std::vector<u8> simdPairs = pairs;
+        Image::Premultiply(simdPairs.data(), 256 * 256, 4);
+        ASSERT(simdPairs == scalarPairs)
+    }
+    ASSERT(Image::SetLevel(Image::BestLevel()))
+
+    TEST_SUCCESS
+}
@@ -0,0 +1,63 @@
+#include <daedalus.h>
+#include <core/image.h>
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace ddls;
+
+// A 2048x2048 texture, larger than the caches as real ones are
+static constexpr u16 Size = 2048;
+static constexpr u64 Pixels = (u64) Size * Size;
+static constexpr u32 Rounds = 8;
+
+static const char *name(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::Sse2: return "SSE2";
+        case SimdLevel::Avx2: return "AVX2";
+        case SimdLevel::Neon: return "NEON";
+        default: return "Scalar";
+    }
+}
+
+static f64 measure(const std::function<void()> &kernel)
+{
+    // Once to warm up the tables and the pages
+    kernel();
+    auto start = std::chrono::steady_clock::now();
+    for (u32 round = 0; round < Rounds; round++) kernel();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<f64, std::milli>(end - start).count() / Rounds;
+}
+
+int main()
+{
+    std::mt19937 random(3);
+    std::vector<u8> rgb(Pixels * 3);
+    for (u8 &byte : rgb) byte = (u8) random();
+    std::vector<u8> rgba(Pixels * 4);
+    std::vector<u8> half(Pixels);
+    std::vector<f32> linear(Pixels);
+    std::vector<u8> srgb(Pixels);
+    Image::ExpandRgbToRgba(rgb.data(), rgba.data(), Pixels);
+    Image::SrgbToLinear(rgb.data(), linear.data(), Pixels);
+
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2, SimdLevel::Neon})
+    {
+        if (!Image::SetLevel(level)) continue;
+
+        std::cout << name(level) << ", ms per " << Size << "x" << Size << " image\n";
+        std::cout << "  RGB to RGBA:    " << measure([&] { Image::ExpandRgbToRgba(rgb.data(), rgba.data(), Pixels); }) << "\n";
+        std::cout << "  Vertical flip:  " << measure([&] { Image::FlipVertically(rgba.data(), (u64) Size * 4, Size); }) << "\n";
+        std::cout << "  Premultiply:    " << measure([&] { Image::Premultiply(rgba.data(), Pixels, 4); }) << "\n";
+        std::cout << "  Linear to sRGB: " << measure([&] { Image::LinearToSrgb(linear.data(), srgb.data(), Pixels); }) << "\n";
+        std::cout << "  Downsample:     " << measure([&] { Image::Downsample(rgba.data(), Size, Size, 4, half.data()); }) << "\n";
+    }
+    Image::SetLevel(Image::BestLevel());
+
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include <daedalus.h>
+#include <core/log.h>
+#include <core/log_trace.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+using namespace ddls;
+
+static constexpr u32 Threads = 4;
+static constexpr u32 Messages = 5000;
+
+static void flood()
+{
+    std::vector<std::thread> threads;
+    for (u32 thread = 0; thread < Threads; thread++)
+    {
+        threads.emplace_back([thread] {
+            for (u32 i = 0; i < Messages; i++) Log::Info("thread ", thread, " message ", i);
+        });
+    }
+    for (std::thread &thread : threads) thread.join();
+}
+
+// Counts the messages written to the log file, and those reported dropped
+static std::pair<u64, u64> countLines(const std::filesystem::path &path)
+{
+    std::ifstream file(path);
+    std::string line;
+    u64 written = 0, dropped = 0;
+    while (std::getline(file, line))
+    {
+        if (line.find(" message ") != std::string::npos) written++;
+        if (line.find(" log messages were dropped") != std::string::npos) dropped += std::stoull(line.substr(line.find("]: ") + 3));
+    }
+    return {written, dropped};
+}
+
+int main()
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "ddls_log_test.log";
+
+    // Once flushed, every message of every thread is in the file
+    Log::OpenLog(path);
+    flood();
+    Log::Flush();
+    ASSERT(countLines(path) == std::make_pair((u64) Threads * Messages, (u64) 0))
+
+    // Lines are stamped with the local time, down to the millisecond
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        ASSERT(std::regex_search(line, std::regex(R"(\[\d\d/\d\d/\d{4} - \d\d:\d\d:\d\d\.\d{3} - INFO\]: thread \d message \d+$)")))
+    }
+
+    // Dropped messages are all accounted for
+    Log::SetOverflow(Log::Overflow::Drop);
+    flood();
+    Log::CloseLog();
+    auto [written, dropped] = countLines(path);
+    ASSERT(written + dropped == 2 * Threads * Messages)
+    Log::SetOverflow(Log::Overflow::Block);
+
+    // Categories have their own level, and are named in their messages
+    Log::OpenLog(path);
+    Log::SetLevel(LogCategory::Renderer, LogLevel::Warning);
+    ASSERT(Log::GetLevel(LogCategory::Renderer) == LogLevel::Warning)
+    ASSERT(!Log::Enabled(LogLevel::Info, LogCategory::Renderer) && Log::Enabled(LogLevel::Info))
+    Log::Info(LogCategory::Renderer, "hidden");
+    Log::Warning(LogCategory::Renderer, "shown");
+    Log::SetLevel(LogCategory::Renderer, LogLevel::Debug);
+    Log::CloseLog();
+    {
+        std::ifstream file(path);
+        std::string line, contents;
+        while (std::getline(file, line)) contents += line;
+        ASSERT(contents.find("WARNING - Renderer]: shown") != std::string::npos)
+        ASSERT(contents.find("hidden") == std::string::npos)
+    }
+
+    // Rate-limited, one-shot and deduplicated statements keep their own state
+    Log::OpenLog(path);
+    for (i32 i = 0; i < 100; i++)
+    {
+        DDLS_LOG_EVERY(Warning, 5, "limited ", i);
+        DDLS_LOG_ONCE(Info, LogCategory::Resources, "once ", i);
+        DDLS_LOG_DEDUP(Error, LogCategory::Renderer, "dedup ", i < 50 ? 0 : 1);
+    }
+    Log::CloseLog();
+    {
+        std::ifstream file(path);
+        std::string line;
+        u64 limited = 0, once = 0, dedup = 0, repeats = 0;
+        while (std::getline(file, line))
+        {
+            if (line.find("]: limited ") != std::string::npos) limited++;
+            if (line.find("]: once ") != std::string::npos) once++;
+            if (line.find("- Renderer]: dedup ") != std::string::npos) dedup++;
+            std::smatch summary;
+            if (std::regex_search(line, summary, std::regex("Renderer\\]: Last message repeated (\\d+) times")))
+                repeats += std::stoull(summary[1]);
+        }
+        // Unless the second changed during the loop
+        ASSERT(limited >= 5 && limited <= 10)
+        ASSERT(once == 1)
+        // The repeats of the last message aren't summarised until it changes or a second passes
+        ASSERT(dedup == 2 && repeats >= 49 && repeats <= 98)
+    }
+
+    std::filesystem::remove(path);
+
+    // Traces are only recorded while a trace log is open, their formats are known whenever it opens
+    enum class Stage : u8 { Load = 3 };
+    Log::Trace<"not {}">(0);
+    std::filesystem::path tracePath = std::filesystem::temp_directory_path() / "ddls_trace_test.dlog";
+    Log::OpenTraceLog(tracePath);
+    Log::Trace<"not {}">(1);
+    Log::Trace<"{} {} {} {:.2f} {} {} {}">(-5, 7u, 'c', 0.5f, true, "text", Stage::Load);
+    Log::Trace<"{}">(std::string(1000, 'x'));
+    Log::Trace<"{} {}">(1);
+    Log::Trace<"{:.2f}">("text");
+    Log::Trace<"{1:*>4}|{0:#x}|{{}}">(255u, "ab");
+    Log::Trace<"{:99999999999}">(1);
+    Log::Trace<"{:.10000f}">(0.5f);
+    std::vector<std::thread> tracers;
+    for (u32 thread = 0; thread < Threads; thread++)
+    {
+        tracers.emplace_back([thread] {
+            for (u32 i = 0; i < Messages; i++) Log::Trace<"thread {} event {}">(thread, i);
+        });
+    }
+    for (std::thread &tracer : tracers) tracer.join();
+    Log::CloseTraceLog();
+    Log::Trace<"not {}">(2);
+
+    std::vector<std::string> lines;
+    std::vector<char> contents;
+    {
+        std::ifstream file(tracePath, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    ASSERT(LogTrace::Decode(contents, [&lines](i64, std::string_view text) { lines.emplace_back(text); }))
+    ASSERT(lines.size() == 8 + Threads * Messages)
+    ASSERT(lines[0] == "not 1")
+    ASSERT(lines[1] == "-5 7 c 0.50 true text 3")
+    // Strings are cut to fit in an event
+    ASSERT(lines[2].size() < LogTrace::MaxEventSize && lines[2].find_first_not_of('x') == std::string::npos)
+    // Mismatched arguments are reported rather than rendered
+    ASSERT(lines[3] == "<mismatched arguments: \"{} {}\">")
+    ASSERT(lines[4] == "<mismatched arguments: \"{:.2f}\">")
+    ASSERT(lines[5] == "**ab|0xff|{}")
+    // As are widths and precisions too large to format
+    ASSERT(lines[6] == "<mismatched arguments: \"{:99999999999}\">")
+    ASSERT(lines[7] == "<mismatched arguments: \"{:.10000f}\">")
+    u32 next[Threads]{};
+    bool ordered = true;
+    for (u64 i = 8; i < lines.size(); i++)
+    {
+        u32 thread, event;
+        std::istringstream(lines[i].substr(7)) >> thread;
+        event = (u32) std::stoul(lines[i].substr(lines[i].rfind(' ') + 1));
+        ordered &= thread < Threads && event == next[thread]++;
+    }
+    ASSERT(ordered)
+
+    // Damaged logs are rejected past what could be decoded
+    contents.resize(contents.size() - 1);
+    lines.clear();
+    ASSERT(!LogTrace::Decode(contents, [&lines](i64, std::string_view text) { lines.emplace_back(text); }))
+    ASSERT(lines.size() == 7 + Threads * Messages)
+    ASSERT(!LogTrace::Decode(std::span<const char>("DLOG", 4), [](i64, std::string_view) {}))
+    std::filesystem::remove(tracePath);
+
+    // Flushing only waits for what was logged before it, however busy the other threads keep the writer,
+    // even with some of them always caught in the middle of copying a long message
+    Log::OpenTraceLog(tracePath);
+    std::atomic<bool> busy = true;
+    std::vector<std::thread> spammers;
+    for (u32 thread = 0; thread < 2 * Threads; thread++)
+    {
+        spammers.emplace_back([&busy, thread] {
+            std::string text(2048, 'a' + (char) thread);
+            while (busy.load()) Log::Trace<"busy {}">(text.c_str());
+        });
+    }
+    std::atomic<u32> flushes = 0;
+    std::thread flusher([&flushes] {
+        for (u32 i = 0; i < 100; i++)
+        {
+            Log::Flush();
+            flushes++;
+        }
+    });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while (flushes.load() < 100 && std::chrono::steady_clock::now() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT(flushes.load() == 100)
+    flusher.join();
+    busy = false;
+    for (std::thread &spammer : spammers) spammer.join();
+    Log::CloseTraceLog();
+    std::filesystem::remove(tracePath);
+
+    TEST_SUCCESS
+}
@@ -0,0 +1,76 @@
+#include <daedalus.h>
+#include <core/lz4.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "test.h"
+
+using namespace ddls;
+
+static bool roundTrip(const std::vector<u8> &input)
+{
+    std::vector<u8> compressed(Lz4::CompressBound(input.size()));
+    u64 compressedSize = Lz4::Compress(input.data(), input.size(), compressed.data(), compressed.size());
+    if (!compressedSize) return false;
+
+    std::vector<u8> output(input.size());
+    return Lz4::Decompress(compressed.data(), compressedSize, output.data(), output.size()) && output == input;
+}
+
+int main()
+{
+    std::mt19937 random(7);
+
+    // Edge sizes, incompressible, repetitive and overlapping data all survive a round trip
+    ASSERT(roundTrip({}))
+    ASSERT(roundTrip({1, 2, 3}))
+    std::vector<u8> noise(100000);
+    for (u8 &byte : noise) byte = (u8) random();
+    ASSERT(roundTrip(noise))
+    std::vector<u8> runs(100000, 'a');
+    ASSERT(roundTrip(runs))
+    std::vector<u8> text;
+    const char *words[] = {"vertex ", "fragment ", "uniform ", "texture ", "sampler2D "};
+    while (text.size() < 200000)
+    {
+        const char *word = words[random() % 5];
+        text.insert(text.end(), word, word + std::strlen(word));
+    }
+    ASSERT(roundTrip(text))
+
+    // Repetitive data shrinks
+    std::vector<u8> compressed(Lz4::CompressBound(text.size()));
+    u64 compressedSize = Lz4::Compress(text.data(), text.size(), compressed.data(), compressed.size());
+    ASSERT(compressedSize > 0 && compressedSize < text.size() / 2)
+
+    // Too small a destination fails instead of overrunning
+    ASSERT(Lz4::Compress(noise.data(), noise.size(), compressed.data(), 1000) == 0)
+    std::vector<u8> output(text.size());
+    ASSERT(!Lz4::Decompress(compressed.data(), compressedSize, output.data(), output.size() - 1))
+
+    // Truncated blocks are rejected
+    for (u64 cut = 1; cut < 64; cut++)
+    {
+        std::vector<u8> truncated(compressed.begin(), compressed.begin() + (i64) (compressedSize - cut));
+        ASSERT(!Lz4::Decompress(truncated.data(), truncated.size(), output.data(), output.size()))
+    }
+
+    // Corrupt blocks may decode to garbage, but never past the destination
+    static constexpr u64 Guards = 64;
+    std::vector<u8> guarded(text.size() + Guards);
+    bool contained = true;
+    for (u32 i = 0; i < 1000; i++)
+    {
+        std::vector<u8> corrupt(compressed.begin(), compressed.begin() + (i64) compressedSize);
+        corrupt[random() % corrupt.size()] ^= (u8) (1 + random() % 255);
+        corrupt.resize(corrupt.size() - random() % 4);
+        std::memset(guarded.data() + text.size(), 0xFD, Guards);
+        Lz4::Decompress(corrupt.data(), corrupt.size(), guarded.data(), text.size());
+        for (u64 j = text.size(); j < guarded.size(); j++) contained &= guarded[j] == 0xFD;
+    }
+    ASSERT(contained)
+
+    TEST_SUCCESS
+}
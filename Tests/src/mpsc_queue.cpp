@@ -0,0 +1,94 @@
+#include <daedalus.h>
+#include <core/mpsc_queue.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+using namespace ddls;
+
+struct Header
+{
+    u32 producer;
+    u32 index;
+};
+
+int main()
+{
+    // Records come out whole and in order, including those wrapping around the ring
+    {
+        MpscQueue queue(4);
+        ASSERT(queue.empty() && queue.maxRecordSize() == 4 * MpscQueue::CellPayload - 4)
+        std::vector<char> record(queue.maxRecordSize());
+        char out[4 * MpscQueue::CellPayload];
+        ASSERT(queue.tryPop(out) == -1)
+        ASSERT(!queue.tryPush(record.data(), record.size() + 1))
+
+        for (u32 lap = 0; lap < 10; lap++)
+        {
+            ASSERT(queue.tryPush("abc", 3))
+            ASSERT(queue.tryPush("0123456789012345678901234567890123456789012345678901234567890123456789", 70))
+            // Only one cell is left
+            ASSERT(!queue.tryPush(record.data(), 60))
+            ASSERT(queue.tryPop(out) == 3 && std::memcmp(out, "abc", 3) == 0)
+            ASSERT(queue.tryPop(out) == 70 && out[69] == '9')
+            ASSERT(queue.tryPush(nullptr, 0))
+            ASSERT(queue.tryPop(out) == 0 && queue.empty())
+        }
+
+        for (u64 i = 0; i < record.size(); i++) record[i] = (char) i;
+        ASSERT(queue.tryPush(record.data(), record.size()))
+        ASSERT(!queue.tryPush("a", 1))
+        ASSERT(queue.tryPop(out) == (i64) record.size() && std::memcmp(out, record.data(), record.size()) == 0)
+    }
+
+    // Concurrent producers never lose nor tear a record, and each one's order is kept
+    {
+        constexpr u32 Producers = 4;
+        constexpr u32 Records = 20000;
+        MpscQueue queue(256);
+        std::vector<std::thread> producers;
+        for (u32 producer = 0; producer < Producers; producer++)
+        {
+            producers.emplace_back([&queue, producer] {
+                char record[300];
+                for (u32 index = 0; index < Records; index++)
+                {
+                    Header header{producer, index};
+                    u64 size = sizeof(Header) + (index * 7 + producer) % 200;
+                    std::memcpy(record, &header, sizeof(Header));
+                    for (u64 i = sizeof(Header); i < size; i++) record[i] = (char) (index + i);
+                    while (!queue.tryPush(record, size)) std::this_thread::yield();
+                }
+            });
+        }
+
+        u32 next[Producers]{};
+        u32 received = 0;
+        bool intact = true;
+        char record[256 * MpscQueue::CellPayload];
+        while (received < Producers * Records)
+        {
+            i64 size = queue.tryPop(record);
+            if (size < 0)
+            {
+                queue.wait();
+                continue;
+            }
+
+            Header header;
+            std::memcpy(&header, record, sizeof(Header));
+            intact &= header.producer < Producers && header.index == next[header.producer];
+            intact &= (u64) size == sizeof(Header) + (header.index * 7 + header.producer) % 200;
+            for (u64 i = sizeof(Header); intact && i < (u64) size; i++) intact &= record[i] == (char) (header.index + i);
+            if (header.producer < Producers) next[header.producer]++;
+            received++;
+        }
+        for (std::thread &producer : producers) producer.join();
+        ASSERT(intact && queue.empty())
+    }
+
+    TEST_SUCCESS
+}
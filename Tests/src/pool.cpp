@@ -0,0 +1,46 @@
+#include <daedalus.h>
+#include <memory/pool_allocator.h>
+
+#include "test.h"
+
+using namespace ddls;
+
+struct Glyph
+{
+    u32 texId;
+    f32 advance;
+
+    Glyph(u32 id, f32 adv) : texId(id), advance(adv) {}
+};
+
+int main()
+{
+    PoolAllocator pool(12, 4, false, 16);
+    ASSERT(pool.blockSize() == 16)
+
+    Ptr blocks[4];
+    for (auto &block : blocks)
+    {
+        block = pool.allocate();
+        ASSERT((ptr)block % 16 == 0)
+    }
+    ASSERT(pool.used() == 4)
+    {
+        ASSERT_THROWS(pool.allocate(), OutOfMemoryException)
+    }
+
+    // The last freed block is the first reused
+    pool.free(blocks[2]);
+    ASSERT(pool.allocate() == blocks[2])
+
+    ObjectPool<Glyph> glyphs(2);
+    Glyph *a = glyphs.create(1u, 0.5f);
+    Glyph *b = glyphs.create(2u, 1.5f);
+    Glyph *c = glyphs.create(3u, 2.5f);
+    ASSERT(glyphs.capacity() == 4)
+    ASSERT(a->texId == 1 && b->texId == 2 && c->texId == 3)
+    glyphs.destroy(b);
+    ASSERT(glyphs.used() == 2)
+
+    TEST_SUCCESS
+}
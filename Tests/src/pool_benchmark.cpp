@@ -0,0 +1,49 @@
+#include <daedalus.h>
+#include <memory/pool_allocator.h>
+
+#include <chrono>
+#include <vector>
+
+using namespace ddls;
+
+struct RenderCommand
+{
+    u32 pipeline;
+    u32 texture;
+    f32 model[16];
+};
+
+static constexpr u32 Live = 4096;
+static constexpr u32 Rounds = 256;
+
+template<typename Allocate, typename Free>
+static f64 churn(Allocate allocate, Free release)
+{
+    std::vector<RenderCommand *> commands(Live);
+    auto start = std::chrono::steady_clock::now();
+    for (u32 round = 0; round < Rounds; round++)
+    {
+        for (auto &command : commands) command = allocate();
+        // Free in a different order than allocated, as a long session would
+        for (u32 i = 0; i < Live; i++) release(commands[(i * 7919) % Live]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<f64, std::nano>(end - start).count() / (f64)(Live * Rounds);
+}
+
+int main()
+{
+    f64 heap = churn(
+        [] { return new RenderCommand(); },
+        [](RenderCommand *command) { delete command; });
+
+    ObjectPool<RenderCommand> pool(Live);
+    f64 pooled = churn(
+        [&] { return pool.create(); },
+        [&](RenderCommand *command) { pool.destroy(command); });
+
+    std::cout << "new/delete: " << heap << " ns per object\n";
+    std::cout << "ObjectPool: " << pooled << " ns per object\n";
+
+    return 0;
+}
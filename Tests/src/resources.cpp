@@ -0,0 +1,169 @@
+#include <daedalus.h>
+#include <core/resources.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include "test.h"
+
+using namespace ddls;
+
+int main()
+{
+    Resources &resources = Resources::Manager();
+    {
+        std::ofstream file(resources.getPath("async.txt"), std::ios::binary);
+        file << "streamed";
+    }
+
+    // Requests for the same path share their load, whatever buffer holds the path
+    {
+        char path[] = "async.txt";
+        FileHandle first = resources.loadFileAsync(path);
+        FileHandle second = resources.loadFileAsync("async.txt");
+        first.wait();
+        ASSERT(first.ready() && second.ready())
+        ASSERT(first.get().data == second.get().data)
+        ASSERT(first.get().size == 8 && std::memcmp(first.get().data, "streamed", 8) == 0)
+
+        // Once loaded, it's served from the cache, null-terminated
+        ASSERT(resources.getFile("async.txt") == first.get().data)
+        ASSERT(std::strcmp(resources.getFile("async.txt"), "streamed") == 0)
+        ASSERT(resources.loadFileAsync("async.txt").ready())
+
+        // Handles keep what they loaded cached
+        resources.free("async.txt");
+        ASSERT(resources.getFile("async.txt") == first.get().data)
+    }
+    resources.free("async.txt");
+    ASSERT(resources.used(AssetClass::Files) == 0)
+
+    // Over budget, the least recently used unreferenced files are evicted
+    std::vector<StringId> evicted;
+    u32 callback = resources.addEvictionCallback([&evicted](AssetClass assetClass, StringId id) {
+        if (assetClass == AssetClass::Files) evicted.push_back(id);
+    });
+    for (const char *name : {"a.txt", "b.txt", "c.txt"})
+    {
+        // Distinct contents, identical ones would be shared
+        std::ofstream file(resources.getPath(name), std::ios::binary);
+        file << "012345678" << name[0];
+    }
+    resources.setBudget(AssetClass::Files, 25);
+    ASSERT(resources.budget(AssetClass::Files) == 25)
+    {
+        FileRef pinned = resources.acquireFile("a.txt");
+        ASSERT(pinned && pinned.get().size == 10)
+        resources.getFile("b.txt");
+        resources.getFile("c.txt");
+        ASSERT(evicted.size() == 1 && evicted[0] == "b.txt"_sid)
+        ASSERT(resources.used(AssetClass::Files) == 20)
+
+        // Shrinking the budget can't evict a referenced file
+        resources.setBudget(AssetClass::Files, 0);
+        ASSERT(evicted.size() == 2 && evicted[1] == "c.txt"_sid)
+        ASSERT(resources.used(AssetClass::Files) == 10)
+        resources.free("a.txt");
+        ASSERT(std::strcmp(resources.getFile("a.txt"), "012345678a") == 0)
+
+        FileRef moved = std::move(pinned);
+        ASSERT(!pinned && moved)
+    }
+    // Dropping the last reference evicts it
+    ASSERT(evicted.size() == 3 && evicted[2] == "a.txt"_sid)
+    ASSERT(resources.used(AssetClass::Files) == 0)
+    resources.removeEvictionCallback(callback);
+    resources.setBudget(AssetClass::Files, Resources::Unlimited);
+    for (const char *name : {"a.txt", "b.txt", "c.txt"}) std::filesystem::remove(resources.getPath(name));
+
+    // Identical contents under different paths share one buffer, counted once
+    for (const char *name : {"copy1.txt", "copy2.txt", "copy3.txt"})
+    {
+        std::ofstream file(resources.getPath(name), std::ios::binary);
+        file << "duplicated";
+    }
+    const char *original = resources.getFile("copy1.txt");
+    ASSERT(resources.getFile("copy2.txt") == original)
+    FileHandle copy = resources.loadFileAsync("copy3.txt");
+    copy.wait();
+    ASSERT(copy.get().data == original)
+    ASSERT(resources.used(AssetClass::Files) == 10)
+    ASSERT(resources.dedupStats(AssetClass::Files).aliases == 2)
+    ASSERT(resources.dedupStats(AssetClass::Files).bytesSaved == 20)
+
+    // The buffer goes with the last path sharing it
+    resources.free("copy1.txt");
+    resources.free("copy2.txt");
+    ASSERT(std::strcmp(resources.getFile("copy3.txt"), "duplicated") == 0)
+    ASSERT(resources.used(AssetClass::Files) == 10 && resources.dedupStats(AssetClass::Files).aliases == 0)
+    copy = FileHandle();
+    resources.free("copy3.txt");
+    ASSERT(resources.used(AssetClass::Files) == 0 && resources.dedupStats(AssetClass::Files).bytesSaved == 0)
+    for (const char *name : {"copy1.txt", "copy2.txt", "copy3.txt"}) std::filesystem::remove(resources.getPath(name));
+
+    // Mapped files are viewed in place, with an explicit length
+    std::span<const char> mapped = resources.mapFile("async.txt");
+    ASSERT(mapped.size() == 8 && std::memcmp(mapped.data(), "streamed", 8) == 0)
+    ASSERT(resources.mapFile("async.txt", FileAccess::Random).data() == mapped.data())
+    resources.free("async.txt");
+    MappedFile empty;
+    ASSERT(!empty.isOpen() && empty.view().empty())
+    ASSERT(!empty.open(resources.getPath("missing.txt")))
+
+    // Failures are reported through the handle
+    FileHandle missing = resources.loadFileAsync("missing.txt");
+    missing.wait();
+    ASSERT(missing.state() == LoadState::Failed)
+    TextureHandle missingTexture = resources.loadTextureAsync("missing.png");
+    missingTexture.wait();
+    ASSERT(missingTexture.state() == LoadState::Failed)
+    ASSERT(FileHandle().state() == LoadState::Failed)
+
+    // Mounted archives are resolved before loose files
+    ArchiveWriter writer;
+    writer.add("async.txt", {'p', 'a', 'c', 'k', 'e', 'd'});
+    writer.add("repeated.txt", std::vector<char>(100000, 'r'), Compression::Lz4Blocks);
+    ASSERT(writer.write(resources.getPath("test.dpak")))
+    ASSERT(resources.mount("test.dpak"))
+    ASSERT(!resources.mount("missing.dpak"))
+    ASSERT(std::strcmp(resources.getFile("async.txt"), "packed") == 0)
+    std::span<const char> packed = resources.mapFile("async.txt");
+    ASSERT(packed.size() == 6 && std::memcmp(packed.data(), "packed", 6) == 0)
+    resources.free("async.txt");
+    std::span<const char> repeated = resources.mapFile("repeated.txt");
+    ASSERT(repeated.size() == 100000 && repeated[0] == 'r' && repeated[99999] == 'r')
+    resources.free("repeated.txt");
+
+    std::filesystem::remove(resources.getPath("async.txt"));
+    std::filesystem::remove(resources.getPath("test.dpak"));
+
+#ifdef DDLS_PLATFORM_LINUX
+    // Files written under the root are freed from the cache and reported, in subdirectories too
+    std::filesystem::create_directories(resources.getPath("watched"));
+    {
+        std::ofstream file(resources.getPath("watched/shader.glsl"), std::ios::binary);
+        file << "old";
+    }
+    ASSERT(std::strcmp(resources.getFile("watched/shader.glsl"), "old") == 0)
+
+    std::atomic<u32> changes = 0;
+    u32 changeCallback = resources.addChangeCallback([&changes](const std::string& path) {
+        if (path == "watched/shader.glsl") changes++;
+    });
+    ASSERT(resources.watch())
+    {
+        std::ofstream file(resources.getPath("watched/shader.glsl"), std::ios::binary);
+        file << "new";
+    }
+    for (u32 i = 0; i < 200 && !changes; i++) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT(changes == 1)
+    ASSERT(std::strcmp(resources.getFile("watched/shader.glsl"), "new") == 0)
+    resources.removeChangeCallback(changeCallback);
+    std::filesystem::remove_all(resources.getPath("watched"));
+#endif
+
+    TEST_SUCCESS
+}
@@ -0,0 +1,105 @@
+#include <daedalus.h>
+#include <core/resources.h>
+#include <core/texture_cooker.h>
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "test.h"
+
+using namespace ddls;
+
+int main()
+{
+    // A 5x3 RGB image, odd sizes exercise the edge clamping and the row padding
+    std::vector<u8> pixels(5 * 3 * 3);
+    for (u64 i = 0; i < pixels.size(); i++) pixels[i] = (u8) (i * 7);
+
+    TextureCookOptions keepRgb;
+    keepRgb.expandRgb = false;
+    keepRgb.srgb = false;
+    std::vector<char> cooked = TextureCooker::Cook(pixels.data(), 5, 3, 3, keepRgb);
+    Texture texture{};
+    ASSERT(TextureCooker::Parse(cooked, texture))
+    ASSERT(texture.cooked && !texture.premultiplied)
+    ASSERT(texture.width == 5 && texture.height == 3 && texture.channels == 3)
+    // 5x3, 2x1 and 1x1
+    ASSERT(texture.mipCount == 3)
+    ASSERT(texture.mipWidth(1) == 2 && texture.mipHeight(1) == 1 && texture.mipWidth(2) == 1)
+    // 15 bytes rows padded to 16, then 6 to 8 and 3 to 4
+    ASSERT(texture.rowPitch(0) == 16 && texture.rowPitch(1) == 8 && texture.rowPitch(2) == 4)
+    ASSERT(texture.size() == 16 * 3 + 8 + 4)
+    ASSERT(cooked.size() == sizeof(CookedTextureHeader) + texture.size())
+    for (u16 y = 0; y < 3; y++)
+    {
+        ASSERT(std::memcmp(texture.mip(0) + y * texture.rowPitch(0), pixels.data() + y * 15, 15) == 0)
+    }
+    // The first texel of level 1 averages texels (0,0), (1,0), (0,1) and (1,1)
+    u32 sum = (u32) pixels[0] + pixels[3] + pixels[15] + pixels[18];
+    ASSERT(texture.mip(1)[0] == (sum + 2) / 4)
+
+    // sRGB colors are averaged in linear space, black and white make a light rather than a mid grey
+    u8 stripes[] = {0, 0, 0, 255, 255, 255, 255, 255};
+    std::vector<char> srgb = TextureCooker::Cook(stripes, 2, 1, 4);
+    ASSERT(TextureCooker::Parse(srgb, texture))
+    ASSERT(std::memcmp(texture.mip(0), stripes, sizeof(stripes)) == 0)
+    ASSERT(texture.mip(1)[0] >= 187 && texture.mip(1)[0] <= 189 && texture.mip(1)[3] == 255)
+
+    // RGB images gain an opaque alpha by default
+    std::vector<char> expanded = TextureCooker::Cook(pixels.data(), 5, 3, 3);
+    ASSERT(TextureCooker::Parse(expanded, texture))
+    ASSERT(texture.channels == 4 && texture.rowPitch(0) == 20)
+    ASSERT(texture.data[0] == pixels[0] && texture.data[2] == pixels[2] && texture.data[3] == 0xFF && texture.data[4] == pixels[3])
+
+    // Premultiplied alpha scales the colors, not the alpha itself
+    u8 translucent[] = {200, 100, 50, 128};
+    std::vector<char> premultiplied = TextureCooker::Cook(translucent, 1, 1, 4, {true, true, 1, true, false});
+    ASSERT(TextureCooker::Parse(premultiplied, texture))
+    ASSERT(texture.premultiplied && texture.mipCount == 1 && texture.rowAlignment == 1)
+    ASSERT(texture.data[0] == 100 && texture.data[1] == 50 && texture.data[2] == 25 && texture.data[3] == 128)
+    // In linear space for sRGB colors, which keeps them brighter once encoded again
+    premultiplied = TextureCooker::Cook(translucent, 1, 1, 4, {true, true, 1});
+    ASSERT(TextureCooker::Parse(premultiplied, texture))
+    ASSERT(texture.data[0] > 100 && texture.data[0] < 200 && texture.data[2] > 25 && texture.data[3] == 128)
+    std::vector<char> flat = TextureCooker::Cook(pixels.data(), 5, 3, 3, {false, true, 4, false});
+    ASSERT(TextureCooker::Parse(flat, texture))
+    ASSERT(texture.mipCount == 1 && !texture.premultiplied)
+
+    // Truncated or foreign data is rejected
+    ASSERT(!TextureCooker::Parse(std::span<const char>(cooked.data(), cooked.size() - 1), texture))
+    ASSERT(!TextureCooker::Parse(std::span<const char>(cooked.data(), 8), texture))
+    std::vector<char> foreign = cooked;
+    foreign[0] = 'X';
+    ASSERT(!TextureCooker::Parse(foreign, texture))
+
+    // Resources loads cooked textures without decoding them
+    Resources &resources = Resources::Manager();
+    {
+        std::ofstream file(resources.getPath("cooked.dtex"), std::ios::binary);
+        file.write(cooked.data(), (std::streamsize) cooked.size());
+    }
+    ASSERT(TextureCooker::IsCooked("cooked.dtex") && !TextureCooker::IsCooked("cooked.png"))
+    Texture loaded = resources.getTexture("cooked.dtex");
+    ASSERT(loaded.cooked && loaded.mipCount == 3)
+    ASSERT(std::memcmp(loaded.data, cooked.data() + sizeof(CookedTextureHeader), loaded.size()) == 0)
+    ASSERT(resources.used(AssetClass::Textures) == loaded.size())
+
+    // A copy under another path shares the loaded levels
+    {
+        std::ofstream file(resources.getPath("copy.dtex"), std::ios::binary);
+        file.write(cooked.data(), (std::streamsize) cooked.size());
+    }
+    Texture copy = resources.getTexture("copy.dtex");
+    ASSERT(copy.data == loaded.data && copy.contentHash == loaded.contentHash)
+    ASSERT(resources.used(AssetClass::Textures) == loaded.size())
+    ASSERT(resources.dedupStats(AssetClass::Textures).bytesSaved == loaded.size())
+
+    resources.free("cooked.dtex");
+    resources.free("copy.dtex");
+    ASSERT(resources.used(AssetClass::Textures) == 0)
+    std::filesystem::remove(resources.getPath("cooked.dtex"));
+    std::filesystem::remove(resources.getPath("copy.dtex"));
+
+    TEST_SUCCESS
+}
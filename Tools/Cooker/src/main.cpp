@@ -0,0 +1,129 @@
+#include <core/image.h>
+#include <core/log.h>
+#include <core/texture_cooker.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace ddls;
+
+static int usage(const char *program)
+{
+    Log::Error("Usage: ", program, " [--premultiply] [--no-mipmaps] [--keep-rgb] [--linear] [--row-alignment <bytes>] <source> <destination>");
+    return EXIT_FAILURE;
+}
+
+static bool cook(const std::filesystem::path &source, const std::filesystem::path &destination,
+    const TextureCookOptions &options)
+{
+    int width, height, channels;
+    stbi_uc *pixels = stbi_load(source.string().c_str(), &width, &height, &channels, 0);
+    if (!pixels)
+    {
+        Log::Error("Cannot decode \"", source.string(), "\": ", stbi_failure_reason());
+        return false;
+    }
+    if (width > 0xFFFF || height > 0xFFFF)
+    {
+        Log::Error("\"", source.string(), "\" is larger than 65535 pixels!");
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    // The first row is the bottom one, as GL expects and like the textures decoded at runtime
+    Image::FlipVertically(pixels, (u64) width * channels, (u32) height);
+    std::vector<char> cooked = TextureCooker::Cook(pixels, (u16) width, (u16) height, (u16) channels, options);
+    stbi_image_free(pixels);
+
+    std::filesystem::create_directories(destination.parent_path());
+    std::ofstream file(destination, std::ios::binary | std::ios::trunc);
+    file.write(cooked.data(), (std::streamsize) cooked.size());
+    if (!file)
+    {
+        Log::Error("Cannot write \"", destination.string(), "\"!");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Cooks an image, or every image under a directory, into textures loaded without decoding
+ * 
+ * Usage: Cooker [--premultiply] [--no-mipmaps] [--keep-rgb] [--linear] [--row-alignment <bytes>] <source> <destination>
+ * 
+ * Directories are cooked into a destination directory mirroring them,
+ * each image renamed with the cooked texture extension.
+ * Colors are taken as sRGB, --linear is for normal maps and other data.
+ * 
+ */
+int main(int argc, char **argv)
+{
+    TextureCookOptions options;
+    int first = 1;
+    for (; first < argc && std::string(argv[first]).starts_with("--"); first++)
+    {
+        std::string option = argv[first];
+        if (option == "--premultiply") options.premultiply = true;
+        else if (option == "--no-mipmaps") options.mipmaps = false;
+        else if (option == "--keep-rgb") options.expandRgb = false;
+        else if (option == "--linear") options.srgb = false;
+        else if (option == "--row-alignment" && first + 1 < argc)
+        {
+            std::string_view text = argv[++first];
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), options.rowAlignment);
+            if (error != std::errc() || end != text.data() + text.size()) return usage(argv[0]);
+        }
+        else
+        {
+            Log::Error("Unknown option ", option);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - first != 2) return usage(argv[0]);
+    if (!isPowerOfTwo(options.rowAlignment) || options.rowAlignment > 8)
+    {
+        Log::Error("Row alignment ", options.rowAlignment, " must be a power of two up to 8!");
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path source = argv[first];
+    std::filesystem::path destination = argv[first + 1];
+    if (!std::filesystem::is_directory(source))
+    {
+        return cook(source, destination, options) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    u32 count = 0;
+    std::error_code error;
+    for (const auto &file : std::filesystem::recursive_directory_iterator(source, error))
+    {
+        if (!file.is_regular_file()) continue;
+
+        int width, height, channels;
+        // Skips whatever isn't an image stb can decode
+        if (!stbi_info(file.path().string().c_str(), &width, &height, &channels)) continue;
+
+        std::filesystem::path cooked = destination / file.path().lexically_relative(source);
+        cooked.replace_extension(TextureCooker::Extension);
+        if (!cook(file.path(), cooked, options)) return EXIT_FAILURE;
+        count++;
+    }
+    if (error)
+    {
+        Log::Error("Cannot list \"", source.string(), "\": ", error.message());
+        return EXIT_FAILURE;
+    }
+    Log::Info("Cooked ", count, " textures into \"", destination.string(), "\"");
+
+    return EXIT_SUCCESS;
+}
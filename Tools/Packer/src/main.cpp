@@ -0,0 +1,84 @@
+#include <core/archive.h>
+#include <core/log.h>
+#include <core/memory.h>
+
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+using namespace ddls;
+
+static int usage(const char *program)
+{
+    Log::Error("Usage: ", program, " [--compress] <archive> <directory> [alignment]");
+    return EXIT_FAILURE;
+}
+
+/**
+ * @brief Packs every file under a directory into an archive, named by their path relative to it
+ * 
+ * Usage: Packer [--compress] <archive> <directory> [alignment]
+ * 
+ * With --compress, files are stored as LZ4 blocks whenever that makes them smaller.
+ * 
+ */
+int main(int argc, char **argv)
+{
+    Compression compression = Compression::None;
+    int first = 1;
+    if (argc > 1 && std::string(argv[1]) == "--compress")
+    {
+        compression = Compression::Lz4Blocks;
+        first++;
+    }
+
+    if (argc - first < 2) return usage(argv[0]);
+
+    std::filesystem::path archivePath = argv[first];
+    std::filesystem::path root = argv[first + 1];
+    u32 alignment = Archive::DefaultAlignment;
+    if (argc - first > 2)
+    {
+        std::string_view text = argv[first + 2];
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), alignment);
+        if (error != std::errc() || end != text.data() + text.size()) return usage(argv[0]);
+    }
+    if (!isPowerOfTwo(alignment))
+    {
+        Log::Error("Alignment ", alignment, " is not a power of two!");
+        return EXIT_FAILURE;
+    }
+
+    ArchiveWriter writer(alignment);
+    u64 bytes = 0;
+    std::error_code error;
+    for (const auto &file : std::filesystem::recursive_directory_iterator(root, error))
+    {
+        if (!file.is_regular_file()) continue;
+
+        // Names use forward slashes on every platform, as passed to Resources
+        std::string name = file.path().lexically_relative(root).generic_string();
+        if (!writer.addFile(name, file.path(), compression))
+        {
+            Log::Error("Cannot read \"", file.path().string(), "\"!");
+            return EXIT_FAILURE;
+        }
+        bytes += file.file_size();
+    }
+    if (error)
+    {
+        Log::Error("Cannot list \"", root.string(), "\": ", error.message());
+        return EXIT_FAILURE;
+    }
+
+    if (!writer.write(archivePath))
+    {
+        Log::Error("Cannot write \"", archivePath.string(), "\"!");
+        return EXIT_FAILURE;
+    }
+    Log::Info("Packed ", writer.entryCount(), " files (", bytes, " bytes) into \"", archivePath.string(), "\"");
+
+    return EXIT_SUCCESS;
+}
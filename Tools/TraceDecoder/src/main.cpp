@@ -0,0 +1,55 @@
+#include <core/log.h>
+#include <core/log_trace.h>
+#include <core/mapped_file.h>
+#include <core/time.h>
+
+#include <fmt/format.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+
+using namespace ddls;
+
+/**
+ * @brief Renders a binary trace log written by Log::Trace() as text, one event per line
+ * 
+ * Usage: TraceDecoder <trace log>
+ * 
+ * Lines are stamped with the local time of their event, like the text log.
+ * 
+ */
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        Log::Error("Usage: ", argv[0], " <trace log>");
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path path = argv[1];
+    MappedFile file;
+    if (!file.open(path, FileAccess::Sequential))
+    {
+        Log::Error("Cannot open \"", path.string(), "\"!");
+        return EXIT_FAILURE;
+    }
+
+    u64 events = 0;
+    Boolean valid = LogTrace::Decode(file.view(), [&events](i64 timestamp, std::string_view text) {
+        std::tm local = Time::LocalTime((std::time_t) (timestamp / 1000000));
+        char date[64];
+        std::size_t length = std::strftime(date, sizeof(date), Log::TimestampFormat, &local);
+        fmt::print("[{}.{:03}]: {}\n", std::string_view(date, length), timestamp / 1000 % 1000, text);
+        events++;
+    });
+    std::fflush(stdout);
+    if (!valid)
+    {
+        Log::Error("\"", path.string(), "\" is not a valid trace log, or is truncated after ", events, " events!");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}